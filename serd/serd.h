@@ -663,6 +663,99 @@ typedef SerdStatus (*SerdStatementSink)(void*              handle,
 typedef SerdStatus (*SerdEndSink)(void*           handle,
                                   const SerdNode* node);
 
+/**
+   A statement passed to a SerdStatementBatchSink.
+*/
+typedef struct {
+	SerdStatementFlags flags;            /**< Statement flags */
+	const SerdNode*    graph;            /**< Graph, or NULL */
+	const SerdNode*    subject;          /**< Subject */
+	const SerdNode*    predicate;        /**< Predicate */
+	const SerdNode*    object;           /**< Object */
+	const SerdNode*    object_datatype;  /**< Object datatype, or NULL */
+	const SerdNode*    object_lang;      /**< Object language, or NULL */
+} SerdStatement;
+
+/**
+   Sink (callback) for batches of statements.
+
+   Called with `n_statements` statements in the order they were read.  The
+   statements and their nodes are only valid until the sink returns.
+*/
+typedef SerdStatus (*SerdStatementBatchSink)(void*                handle,
+                                             const SerdStatement* statements,
+                                             size_t               n_statements);
+
+/**
+   ID of a node interned by a reader, or zero for no node.
+
+   See serd_reader_set_statement_id_sink().
+*/
+typedef uint64_t SerdTermId;
+
+/**
+   The IDs of the nodes of a statement passed to a SerdStatementIdSink.
+*/
+typedef struct {
+	SerdTermId graph;            /**< Graph, or zero */
+	SerdTermId subject;          /**< Subject */
+	SerdTermId predicate;        /**< Predicate */
+	SerdTermId object;           /**< Object */
+	SerdTermId object_datatype;  /**< Object datatype, or zero */
+	SerdTermId object_lang;      /**< Object language, or zero */
+} SerdStatementIds;
+
+/**
+   Sink (callback) for statements with the IDs of their nodes.
+
+   Called for every RDF statement in the serialisation, with the `ids` of the
+   nodes of `statement`.  The statement and its nodes are only valid until the
+   sink returns.
+*/
+typedef SerdStatus (*SerdStatementIdSink)(void*                   handle,
+                                          const SerdStatement*    statement,
+                                          const SerdStatementIds* ids);
+
+/**
+   Counters of the work done by a reader.
+
+   The counters accumulate over everything read by the reader since it was
+   created.  Time spent in sinks is only measured if enabled with
+   serd_reader_set_sink_timing(), since reading a clock for every statement is
+   not free.
+*/
+typedef struct {
+	uint64_t n_bytes;       /**< Bytes of input read */
+	uint64_t n_statements;  /**< Statements passed to the sinks */
+	uint64_t n_nodes;       /**< Nodes pushed on the stack */
+	size_t   stack_peak;    /**< Largest stack size in bytes */
+	double   sink_time;     /**< Seconds spent in sinks, or zero */
+	uint64_t n_errors;      /**< Errors, including those not reported */
+	uint64_t n_term_hits;       /**< Nodes found in the term table */
+	uint64_t n_term_misses;     /**< Nodes given a new ID */
+	uint64_t n_term_evictions;  /**< Nodes evicted from the term table */
+} SerdReaderStats;
+
+/**
+   Counters of the work done by a writer.
+
+   Time spent in the output sink is only measured if enabled with
+   serd_writer_set_sink_timing().
+*/
+typedef struct {
+	uint64_t n_bytes;       /**< Bytes of output written */
+	uint64_t n_statements;  /**< Statements written */
+	double   sink_time;     /**< Seconds spent in the output sink, or zero */
+} SerdWriterStats;
+
+/**
+   Sink (callback) for reading progress.
+
+   Called periodically while reading, see serd_reader_set_progress_sink().
+*/
+typedef void (*SerdProgressSink)(void*                  handle,
+                                 const SerdReaderStats* stats);
+
 /**
    @}
    @name Environment
@@ -784,11 +877,230 @@ serd_reader_new(SerdSyntax        syntax,
    The reader is non-strict (lax) by default, which will tolerate URIs with
    invalid characters.  Setting strict will fail when parsing such files.  An
    error is printed for invalid input in either case.
+
+   When lax, a statement with a syntax error is skipped, and reading continues
+   with the next one.  A statement in Turtle or TriG which spans several lines
+   is taken to end at the next line that ends with a '.' or '}' outside any
+   brackets, so an error in a TriG graph skips the rest of the graph.  In
+   NTriples, the rest of the line is skipped.  A syntax error in NQuads still
+   stops reading.
 */
 SERD_API
 void
 serd_reader_set_strict(SerdReader* reader, bool strict);
 
+/**
+   Enable or disable zero-copy node views (disabled by default).
+
+   When enabled and the input is a string or a memory-mapped file (see
+   serd_reader_read_file_handle()), terms which appear verbatim in the input
+   are passed to sinks as views into the input rather than copies.  This
+   applies to IRIs, prefixed names, blank node labels, and string literals
+   without any escapes.
+
+   Note that the string of such a node is NOT null terminated, so sinks must
+   respect the `n_bytes` field of nodes when this is enabled.  In particular,
+   a SerdWriter can not be used as a sink.
+*/
+SERD_API
+void
+serd_reader_set_node_views(SerdReader* reader, bool node_views);
+
+/**
+   Enable or disable validation only (disabled by default).
+
+   When enabled, the input is checked as usual, and errors are reported to the
+   error sink, but statements are not passed to the statement sink or end
+   sink.  This is faster since terms are not copied where they appear
+   verbatim in the input, from any source.  Directives are still passed to the
+   base and prefix sinks, and statements are still counted in the reader
+   statistics.
+
+   Since there may be no writer to report them, prefixed names with an
+   undefined prefix are reported as errors by the reader when validating.
+*/
+SERD_API
+void
+serd_reader_set_validate_only(SerdReader* reader, bool validate_only);
+
+/**
+   Set the number of pages to read ahead of the parser.
+
+   When `n_pages` is at least 2, streams which are read a page at a time are
+   read by a background thread into a ring of `n_pages` pages, so reading
+   overlaps with parsing.  This helps with slow sources such as pipes from a
+   decompressor or network file systems, particularly with large pages (see
+   serd_reader_set_page_size()).  Regular files read with fread() are read
+   with io_uring instead where it is available, with a read of each page the
+   parser is not using in flight.  Strings, memory-mapped files, and streams
+   read one byte at a time are not affected.
+
+   The stream is read ahead of the parser, so it must not be used by anything
+   else until the reader is finished with it, and it may be read further than
+   the end of the document when reading statements one at a time.
+*/
+SERD_API
+void
+serd_reader_set_read_ahead(SerdReader* reader, unsigned n_pages);
+
+/**
+   Set a sink to receive statements in batches.
+
+   When set, statements are passed to `batch_sink` in batches of up to
+   `batch_size` statements instead of to the statement sink, which saves the
+   overhead of a call per statement and suits sinks which insert in bulk.  The
+   nodes of batched statements are copied into an arena owned by the reader,
+   with repeated nodes shared, until the batch is passed on.
+
+   A batch is passed on when it is full, before any other event so events stay
+   in order, and before any function which reads input returns.  If the sink
+   returns an error, reading fails as it would for a statement sink, at the
+   statement which completed the batch.  A NULL `batch_sink` restores the
+   statement sink.  The default `batch_size` if it is zero is 4096.
+
+   @return The status of passing on the current batch, if there is one.
+*/
+SERD_API
+SerdStatus
+serd_reader_set_statement_batch_sink(SerdReader*            reader,
+                                     SerdStatementBatchSink batch_sink,
+                                     size_t                 batch_size);
+
+/**
+   Set a sink to receive statements with IDs for their nodes.
+
+   When set, the nodes of each statement are interned in a table owned by the
+   reader, and statements are passed to `id_sink` with the ID of each node
+   instead of to the statement sink.  Nodes with the same type and string have
+   the same ID, so a sink can map IDs to its own terms without hashing
+   strings.  The ID of a literal is of its string only, since its datatype and
+   language have IDs of their own.
+
+   IDs are assigned from 1 in the order nodes are first read, so a node is new
+   if its ID is greater than any seen before, and an ID is never reused for
+   another node.  IDs are only meaningful for one reader.
+
+   The table uses at most about `capacity` bytes, or 16 MiB if it is zero.  It
+   has two generations, and when the newer is full, the older is dropped, so
+   nodes which have not been read recently are evicted, and given a new ID if
+   they are read again.  Nodes too large to fit are given a new ID every time.
+   Hits, misses, and evictions are counted in the reader statistics.
+
+   Like the statement sink, `id_sink` is not used while a batch sink is set, or
+   when validating.  A NULL `id_sink` frees the table and restores the
+   statement sink.
+*/
+SERD_API
+void
+serd_reader_set_statement_id_sink(SerdReader*         reader,
+                                  SerdStatementIdSink id_sink,
+                                  size_t              capacity);
+
+/**
+   Set the size of pages read from files.
+
+   This is used when files are read a page at a time by
+   serd_reader_start_stream() and serd_reader_read_file_handle(), for example
+   when the input is a pipe.  The default is 4096 bytes.  If `page_size` is
+   zero, a size is chosen for each file from its preferred block size and
+   size, which is larger for most file systems.
+*/
+SERD_API
+void
+serd_reader_set_page_size(SerdReader* reader, size_t page_size);
+
+/**
+   Set how the stack of nodes being read grows and shrinks.
+
+   The reader keeps the nodes of the statement being read on a stack, which
+   starts at 4096 bytes and grows by a factor of 1.5 when full.  A huge
+   literal, for example, grows it to at least the size of the literal, which
+   is kept until the reader is freed by default.
+
+   @param reader The reader.
+   @param initial_size Size to allocate now, or zero to leave it unchanged.
+   Use the peak reported by serd_reader_get_stack_peak() for similar input to
+   avoid growing while reading.
+   @param growth Factor to grow the stack by when it is full, which must be
+   greater than 1, or 0 for the default.
+   @param high_water If not zero, the stack is shrunk back to this size after
+   any top-level statement which grew it beyond this size.
+*/
+SERD_API
+void
+serd_reader_set_stack_policy(SerdReader* reader,
+                             size_t      initial_size,
+                             double      growth,
+                             size_t      high_water);
+
+/**
+   Return the largest number of bytes the stack of `reader` has used.
+
+   This includes stacks used by other threads when reading in parallel with
+   serd_reader_read_file_parallel().
+*/
+SERD_API
+size_t
+serd_reader_get_stack_peak(const SerdReader* reader);
+
+/**
+   Return the counters of the work done by `reader` so far.
+
+   This includes work done by other threads when reading in parallel with
+   serd_reader_read_file_parallel(), which is counted as each chunk of input
+   is passed to the sinks.
+*/
+SERD_API
+SerdReaderStats
+serd_reader_get_stats(const SerdReader* reader);
+
+/**
+   Return the number of errors with `status` that `reader` has had so far.
+
+   Like the total in the counters returned by serd_reader_get_stats(), this
+   includes errors which were only counted (see serd_reader_set_error_limit()).
+*/
+SERD_API
+uint64_t
+serd_reader_get_error_count(const SerdReader* reader, SerdStatus status);
+
+/**
+   Set whether the time spent in the sinks of `reader` is measured.
+
+   This reads a monotonic clock around every call to a sink, which is cheap
+   but not negligible for fast sinks, so it is disabled by default.  Where no
+   such clock is available, the time is always zero.
+*/
+SERD_API
+void
+serd_reader_set_sink_timing(SerdReader* reader, bool timed);
+
+/**
+   Set a function to be called with the counters of `reader` periodically.
+
+   The `progress_sink` is called with `handle` as every `interval`th
+   statement is passed on, before the statement sink, from the thread which
+   calls the sinks.  A NULL `progress_sink` or a zero `interval` disables it.
+*/
+SERD_API
+void
+serd_reader_set_progress_sink(SerdReader*      reader,
+                              SerdProgressSink progress_sink,
+                              void*            handle,
+                              uint64_t         interval);
+
+/**
+   Set the number of errors to report before only counting them.
+
+   By default, every error is passed to the error sink.  After `max_errors`
+   more have been, errors are only counted (see
+   serd_reader_get_error_count()), which is much faster for input with many
+   errors since their positions are not calculated.
+*/
+SERD_API
+void
+serd_reader_set_error_limit(SerdReader* reader, uint64_t max_errors);
+
 /**
    Set a function to be called when errors occur during reading.
 
@@ -822,6 +1134,23 @@ void
 serd_reader_add_blank_prefix(SerdReader*    reader,
                              const uint8_t* prefix);
 
+/**
+   Set the radix of the numbers in generated blank node IDs.
+
+   Anonymous blank nodes, like `[]` in Turtle, are given IDs like "b123" after
+   any prefix added with serd_reader_add_blank_prefix().  A radix of 36 or 62
+   gives shorter IDs, using lowercase, or lowercase and uppercase, letters as
+   digits.  These IDs are prefixed with a zero if they would start with a
+   letter, so labels in the input like "b1" are still renamed to avoid clashes.
+
+   @param reader The reader.
+   @param radix 10 (the default), 36, or 62.
+   @return SERD_ERR_BAD_ARG if `radix` is not supported.
+*/
+SERD_API
+SerdStatus
+serd_reader_set_blank_id_radix(SerdReader* reader, unsigned radix);
+
 /**
    Set the URI of the default graph.
 
@@ -836,6 +1165,8 @@ serd_reader_set_default_graph(SerdReader*     reader,
 
 /**
    Read a file at a given `uri`.
+
+   The file may be compressed, see serd_reader_read_file_handle().
 */
 SERD_API
 SerdStatus
@@ -849,6 +1180,10 @@ serd_reader_read_file(SerdReader*    reader,
    efficient, but uses a page of memory and means that an entire page of input
    must be ready before any callbacks will fire.  To react as soon as input
    arrives, set `bulk` to false.
+
+   Compressed input is detected as in serd_reader_read_file_handle().  Only
+   as many bytes as could start a compressed format are read to detect it,
+   so plain input is not held back.
 */
 SERD_API
 SerdStatus
@@ -891,8 +1226,90 @@ SERD_API
 SerdStatus
 serd_reader_end_stream(SerdReader* reader);
 
+/**
+   Read input as it arrives, without blocking.
+
+   This is an alternative to the stream functions for input which arrives in
+   pieces, for example from a non-blocking socket in an event loop.  All
+   complete statements in the input fed so far are read, and any incomplete
+   statement at the end is kept to be read when the rest of it is fed.  The
+   input may be split anywhere, even in the middle of a token or character.
+
+   Only an incomplete statement is copied, so `buf` does not need to stay
+   valid after this returns.  Nodes passed to sinks are only valid during the
+   call, as usual.
+
+   @return An error if reading a statement failed, or SERD_FAILURE if the
+   input was ended by a null byte.  In either case, nothing more is read
+   until serd_reader_finish() is called.
+*/
+SERD_API
+SerdStatus
+serd_reader_feed(SerdReader* reader, const uint8_t* buf, size_t len);
+
+/**
+   Finish reading input fed with serd_reader_feed().
+
+   This reads any remaining input as the end of the document, so an
+   incomplete statement is an error.  Afterwards, the reader is ready to be
+   fed another document.
+*/
+SERD_API
+SerdStatus
+serd_reader_finish(SerdReader* reader);
+
+/**
+   A position at a statement boundary where reading can be resumed.
+
+   The offset is in bytes from the start of the input as read, so for
+   compressed input it is an offset in the decompressed text.
+*/
+typedef struct {
+	uint64_t offset;      /**< Byte offset of the position in the input */
+	unsigned line;        /**< Line number of the position */
+	unsigned col;         /**< Column number of the position */
+	unsigned next_id;     /**< Number of the next generated blank ID */
+	bool     seen_genid;  /**< True iff a label like a generated ID was read */
+	SerdNode env;         /**< Base and prefix directives in Turtle, or null */
+} SerdCheckpoint;
+
+/**
+   Return the position after the last complete statement that was read.
+
+   Statements up to this position have been passed to the sinks, though some
+   after it may have been as well, if reading stopped in the middle of a
+   statement.  The directives in `env` must be freed with serd_node_free().
+*/
+SERD_API
+SerdCheckpoint
+serd_reader_get_checkpoint(const SerdReader* reader);
+
+/**
+   Prepare to resume reading from a checkpoint.
+
+   This passes the base URI and prefixes of the checkpoint to the sinks, and
+   continues generating blank IDs where the checkpoint left off.  The next
+   input, which must start at the checkpoint's offset in the original input
+   (for example a file after fseek()), is then read as the rest of the
+   document, with errors reported at their original line and column.
+*/
+SERD_API
+SerdStatus
+serd_reader_resume(SerdReader* reader, const SerdCheckpoint* checkpoint);
+
 /**
    Read `file`.
+
+   If `file` is a regular file positioned at the start, and memory mapping is
+   supported on this platform, the file is mapped into memory and parsed in
+   place without any intermediate copying.  Otherwise, it is read a page at a
+   time.  Note that in the former case, the file must not be truncated while
+   it is being read.
+
+   Files compressed with gzip (including bgzip), bzip2, or zstd are detected
+   by their first bytes and decompressed a page at a time, where the build
+   supports the format.  Decompression runs in the read-ahead thread if one
+   is enabled (see serd_reader_set_read_ahead()), ahead of the parser.
 */
 SERD_API
 SerdStatus
@@ -900,6 +1317,61 @@ serd_reader_read_file_handle(SerdReader*    reader,
                              FILE*          file,
                              const uint8_t* name);
 
+/**
+   Read `file` using several threads.
+
+   The file is mapped into memory and split into chunks, which are parsed by
+   `n_threads` threads in parallel.  Chunks start at line boundaries for
+   NTriples and NQuads, and after lines which end with a '.' for Turtle and
+   TriG.  A chunk is read again with the next one if this guess was wrong, so
+   documents with many statements that span such lines are read mostly by the
+   calling thread.
+
+   Events are passed to the sinks of `reader` from the calling thread, in the
+   same order and with the same blank node IDs as they would be by
+   serd_reader_read_file_handle(), so the sinks need not be thread-safe.  Files
+   which can not be mapped, compressed files, resumed reads (see
+   serd_reader_resume()), and builds without thread support are read
+   sequentially.
+*/
+SERD_API
+SerdStatus
+serd_reader_read_file_parallel(SerdReader*    reader,
+                               FILE*          file,
+                               const uint8_t* name,
+                               unsigned       n_threads);
+
+/**
+   Set a handle for each thread to pass statements on with in parallel.
+
+   By default, serd_reader_read_file_parallel() passes every event on from
+   the calling thread in order.  With thread handles, the statements of each
+   chunk of input are instead passed to the statement sink by the thread
+   which read the chunk, with `handles[i]` as the handle for the i'th thread,
+   as soon as the chunk is known to be read correctly.  The statements of a
+   chunk are passed on in order, but chunks are passed on in no particular
+   order.  Blank node IDs are the same as for a sequential read.  This lets a
+   sink keep separate state for each thread, without locking, and spreads
+   the work of the sink over the threads.
+
+   Each handle is only used by one thread at a time, and at most `n_handles`
+   threads are used.  Other events and errors are still passed on in order
+   from the calling thread, the time spent in the statement sink is not
+   measured, and checkpoints are not recorded.  A statement sink which
+   returns an error stops reading, but statements in other chunks may still
+   be passed on until the threads stop.  Only a statement sink is called
+   this way, not a batch or ID sink.  Where the file is read sequentially,
+   statements are passed on with the handle of `reader` as usual.
+
+   Setting `n_handles` to zero restores ordered delivery.  The handles are
+   not copied, so they must remain valid until reading is finished.
+*/
+SERD_API
+void
+serd_reader_set_thread_handles(SerdReader*  reader,
+                               void* const* handles,
+                               unsigned     n_handles);
+
 /**
    Read a user-specified byte source.
 */
@@ -1002,6 +1474,55 @@ serd_writer_set_error_sink(SerdWriter*   writer,
                            SerdErrorSink error_sink,
                            void*         error_handle);
 
+/**
+   Set the size of blocks of output passed to the sink.
+
+   By default, output is passed to the sink in blocks of 4096 bytes with
+   #SERD_STYLE_BULK, and as it is written otherwise, which is the same as a
+   `block_size` of 1.  If `block_size` is zero, a size is chosen from the
+   preferred block size of the output file if the sink is serd_file_sink(),
+   or 4096 bytes otherwise.  Any buffered output is flushed first.
+*/
+SERD_API
+void
+serd_writer_set_block_size(SerdWriter* writer, size_t block_size);
+
+/**
+   Set the number of blocks of output to write behind the writer.
+
+   When `n_blocks` is at least 2 and the writer passes blocks of output (see
+   serd_writer_set_block_size()) to serd_file_sink(), blocks are written to
+   the file asynchronously with io_uring, with up to `n_blocks` in flight, so
+   writing overlaps with serialisation.  Where io_uring is unavailable, output
+   is written synchronously as usual.  All blocks are written by the time
+   serd_writer_finish() returns.
+
+   The file must not be written by anything else while the writer is using it.
+*/
+SERD_API
+void
+serd_writer_set_write_behind(SerdWriter* writer, unsigned n_blocks);
+
+/**
+   Return the counters of the work done by `writer` so far.
+
+   Bytes are counted as they are written, which may be before they are passed
+   to the sink if output is written in blocks.
+*/
+SERD_API
+SerdWriterStats
+serd_writer_get_stats(const SerdWriter* writer);
+
+/**
+   Set whether the time spent in the output sink of `writer` is measured.
+
+   When writing behind (see serd_writer_set_write_behind()), this is the time
+   spent waiting to submit blocks.
+*/
+SERD_API
+void
+serd_writer_set_sink_timing(SerdWriter* writer, bool timed);
+
 /**
    Set a prefix to be removed from matching blank node identifiers.
 */
@@ -60,6 +60,18 @@ def parse_time(report):
     return (time, memory)
 
 
+def parse_wall_time(report):
+    "Return elapsed wall clock time from a /usr/bin/time -v report"
+    for line in report.split('\n'):
+        if line.startswith('\tElapsed (wall clock) time'):
+            seconds = 0.0
+            for field in line[line.rfind(' ') + 1:].split(':'):
+                seconds = seconds * 60 + float(field)
+            return seconds
+
+    return None
+
+
 def get_dashes():
     "Generator for plot line dash patterns"
     dash = 2.0
@@ -157,6 +169,162 @@ def run(progs, n_min, n_max, step):
             sys.stderr.write('wrote %s\n' % tsv_filename)
 
 
+def gen_literals(path, n):
+    "Generate Turtle with n statements with long literals"
+    words = ['lorem', 'ipsum', 'dolor', 'sit', 'amet', 'consectetur',
+             'adipiscing', 'elit', 'sed', 'do', 'eiusmod', 'tempor']
+    with open(path, 'w') as out:
+        out.write('@prefix eg: <http://example.org/> .\n')
+        for i in range(n):
+            text = ' '.join(words[(i + j) % len(words)] for j in range(80))
+            if i % 10 == 0:
+                out.write('eg:s%d eg:description """%s\n%s""" .\n' %
+                          (i, text, text))
+            else:
+                out.write('eg:s%d eg:description "%s \\"%d\\"" .\n' %
+                          (i, text, i))
+
+
+def gen_indented(path, n):
+    "Generate pretty-printed Turtle with n statements and many comments"
+    with open(path, 'w') as out:
+        out.write('@prefix eg: <http://example.org/> .\n')
+        for i in range(0, n, 4):
+            out.write('\n# Resource %d, described by four statements\n' % i)
+            out.write('eg:s%d\n' % i)
+            out.write('        eg:p1 eg:o%d ;  # First\n' % i)
+            out.write('        eg:p2 [\n')
+            out.write('                eg:p3 %d ;\n' % i)
+            out.write('                eg:p4 "%d"\n' % i)
+            out.write('        ] .\n')
+
+
+def gen_prefixes(path, n):
+    "Generate Turtle with n statements and a new prefix every 20 statements"
+    with open(path, 'w') as out:
+        for i in range(n):
+            if i % 20 == 0:
+                out.write('@prefix p%d: <http://example.org/p%d/> .\n' %
+                          (i // 20, i // 20))
+            out.write('p%d:s%d p0:p p%d:o%d .\n' % (i // 20, i, i // 20, i))
+
+
+def gen_tokens(path, n):
+    "Generate Turtle with n statements of long names, numbers, and tags"
+    langs = ['en', 'en-GB', 'fr', 'de-CH-1996', 'zh-Hant-TW']
+    with open(path, 'w') as out:
+        out.write('@prefix exampleVocabulary: <http://example.org/vocab#> .\n')
+        out.write('@prefix exampleResource: <http://example.org/res/> .\n')
+        for i in range(n):
+            subject = 'exampleResource:subjectResource%d' % (i // 4)
+            if i % 4 == 0:
+                out.write('%s exampleVocabulary:integerProperty %d .\n' %
+                          (subject, 1234567 * i))
+            elif i % 4 == 1:
+                out.write('%s exampleVocabulary:decimalProperty -%d.%06d .\n' %
+                          (subject, i, i % 999983))
+            elif i % 4 == 2:
+                out.write('%s exampleVocabulary:labelProperty "l%d"@%s .\n' %
+                          (subject, i, langs[i % len(langs)]))
+            else:
+                out.write('%s exampleVocabulary:blankProperty '
+                          '_:blankNodeLabel%d .\n' % (subject, i))
+
+
+def time_command(cmd):
+    "Return the user time of a command with output discarded, or None"
+    with open(os.devnull, 'w') as out:
+        sys.stderr.write(cmd + '\n')
+        proc = subprocess.Popen(
+            ['/usr/bin/time', '-v'] + cmd.split(),
+            stdout=out, stderr=subprocess.PIPE)
+
+        time, _ = parse_time(proc.communicate()[1].decode())
+        return None if proc.returncode else time
+
+
+def run_cases(serdis, n):
+    "Benchmark reading generated inputs with each serdi, with and without -V"
+    cases = [('literals', gen_literals),
+             ('indented', gen_indented),
+             ('prefixes', gen_prefixes),
+             ('tokens', gen_tokens)]
+    with WorkingDirectory('build'):
+        with open('serdi-cases.txt', 'w') as results:
+            results.write('case\tcommand\tbytes\ttime\tbytes/s\n')
+            for name, generate in cases:
+                path = 'case-%s-%d.ttl' % (name, n)
+                if not os.path.exists(path):
+                    generate(path, n)
+
+                size = os.path.getsize(path)
+                for serdi in serdis:
+                    for flags in ['-i turtle -o ntriples', '-V -i turtle']:
+                        prog = '%s %s' % (serdi, flags)
+                        time = time_command('%s %s' % (prog, path))
+                        row = [name, prog, str(size)]
+                        if time is None:
+                            row += ['-', '-']  # Unsupported, like old -V
+                        else:
+                            row += ['%.07f' % time,
+                                    '%d' % (size / max(time, 0.01))]
+                        results.write('\t'.join(row) + '\n')
+
+        sys.stderr.write('wrote serdi-cases.txt\n')
+
+
+def gen_ntriples(path, n):
+    "Generate NTriples with n statements and a blank subject every 1000"
+    with open(path, 'w') as out:
+        for i in range(n):
+            subject = '_:b%d' % (i // 1000) if i % 1000 == 0 else \
+                '<http://example.org/s%d>' % (i // 10)
+            out.write('%s <http://example.org/p%d> "%d" .\n' %
+                      (subject, i % 10, i))
+
+
+def thread_counts(max_threads):
+    "Return powers of two up to max_threads, and max_threads itself"
+    counts = [1]
+    while counts[-1] * 2 < max_threads:
+        counts += [counts[-1] * 2]
+    return counts + [max_threads] if max_threads > 1 else counts
+
+
+def run_scaling(serdis, n, max_threads):
+    "Benchmark reading NTriples with each serdi and 1 to max_threads threads"
+    path = 'case-ntriples-%d.nt' % n
+    progs = ['%s %s' % (serdi, flags)
+             for serdi in serdis
+             for flags in ['-i ntriples -o ntriples', '-V -i ntriples']]
+    with WorkingDirectory('build'):
+        if not os.path.exists(path):
+            gen_ntriples(path, n)
+
+        with open('serdi-scaling.txt', 'w') as results:
+            results.write('\t'.join(['threads'] + progs) + '\n')
+            for n_threads in thread_counts(max_threads):
+                row = [str(n_threads)]
+                for prog in progs:
+                    # Threads reduce the elapsed time, not the time used
+                    cmd = '/usr/bin/time -v %s -j %d %s' % (
+                        prog.split()[0], n_threads,
+                        ' '.join(prog.split()[1:] + [path]))
+                    with open(os.devnull, 'w') as out:
+                        sys.stderr.write(cmd + '\n')
+                        proc = subprocess.Popen(
+                            cmd.split(), stdout=out, stderr=subprocess.PIPE)
+                        time = parse_wall_time(proc.communicate()[1].decode())
+
+                    if proc.returncode or time is None:
+                        row += ['nan']  # Unsupported, like old serdi -j
+                    else:
+                        row += ['%d' % (n / max(time, 0.01))]
+                results.write('\t'.join(row) + '\n')
+
+        sys.stderr.write('wrote serdi-scaling.txt\n')
+
+
 def plot_results():
     "Plot all benchmark results"
     with WorkingDirectory('build'):
@@ -174,7 +342,9 @@ if __name__ == "__main__":
             return self.expand_prog_name(self.epilog)
 
     opt = OptParser(
-        usage='%prog [OPTION]... SP2B_DIR',
+        usage='%prog [OPTION]... SP2B_DIR\n'
+              '       %prog --cases [OPTION]...\n'
+              '       %prog --scaling [OPTION]...',
         description='Benchmark RDF reading and writing commands\n',
         epilog='''
 Example:
@@ -182,6 +352,11 @@ Example:
       --run 'rapper -i turtle -o turtle' \\
       --run 'riot --output=ttl' \\
       --run 'rdfpipe -i turtle -o turtle' /path/to/sp2b/src/
+
+  %prog --cases --max 200000 \\
+      --serdi /path/to/old/serdi --serdi build/serdi
+
+  %prog --scaling --max 5000000 --threads 8 --serdi build/serdi
 ''')
 
     opt.add_option('--max', type='int', default=1000000,
@@ -194,9 +369,30 @@ Example:
                    help='do not run benchmarks')
     opt.add_option('--no-plot', action='store_true',
                    help='do not plot benchmarks')
+    opt.add_option('--cases', action='store_true',
+                   help='only benchmark serdi on generated literal-heavy, '
+                        'indented, prefix-heavy, and name- and number-heavy '
+                        'input, with and without -V')
+    opt.add_option('--serdi', type='string', action='append', default=[],
+                   help='serdi command to run cases with, to compare builds')
+    opt.add_option('--scaling', action='store_true',
+                   help='only benchmark serdi -j on generated NTriples with 1 '
+                        'to THREADS threads, with and without -V')
+    opt.add_option('--threads', type='int', default=os.cpu_count() or 1,
+                   help='maximum number of threads for --scaling')
 
     (options, args) = opt.parse_args()
-    if len(args) != 1:
+    if options.cases:
+        run_cases(options.serdi or ['serdi'], options.max)
+        sys.exit(0)
+    elif options.scaling:
+        run_scaling(options.serdi or ['serdi'], options.max, options.threads)
+        if not options.no_plot:
+            with WorkingDirectory('build'):
+                plot(open('serdi-scaling.txt', 'r'), 'serdi-scaling.svg',
+                     'Threads', 'Statements / s')
+        sys.exit(0)
+    elif len(args) != 1:
         opt.print_usage()
         sys.exit(1)
 
@@ -16,10 +16,301 @@
 
 #include "serd_internal.h"
 
+#if defined(HAVE_MMAP) && defined(HAVE_FSTAT) && defined(HAVE_FILENO)
+#    include <sys/mman.h>
+#endif
+
+#if defined(HAVE_FSTAT) && defined(HAVE_FILENO)
+#    include <sys/stat.h>
+#endif
+
+#ifdef HAVE_PTHREAD
+#    include <pthread.h>
+
+/// A page read by the read-ahead thread
+typedef struct {
+	uint8_t*   buf;     ///< Page contents
+	SerdStatus status;  ///< Status of reading, failure at the end of stream
+	int        error;   ///< Value of errno after a read error
+} Page;
+
+/**
+   A thread which reads pages from a stream into a ring.
+
+   The reader holds at most one page at a time, which it releases when it
+   asks for the next one.  The thread stops after reading the last page,
+   which is never released so it is returned to the reader every time.
+
+   Regular files are instead read with io_uring where it is available, which
+   keeps a read of every page but the one held by the reader in flight,
+   without a thread.
+*/
+struct SerdReadAheadImpl {
+	SerdSource          read_func;  ///< Read function (e.g. fread)
+	SerdStreamErrorFunc error_func; ///< Error function (e.g. ferror)
+	void*               stream;     ///< Stream (e.g. FILE)
+	size_t              page_size;  ///< Size of a page in bytes
+	Page*               pages;      ///< Ring of pages
+	unsigned            n_pages;    ///< Number of pages in ring
+	unsigned            head;       ///< Index of the next page to fill
+	unsigned            tail;       ///< Index of the next page to read
+	unsigned            n_full;     ///< Number of pages filled but not read
+	bool                reading;    ///< True iff the reader holds a page
+	bool                done;       ///< True iff the last page has been read
+	bool                stop;       ///< True iff the thread should stop
+	pthread_t           thread;     ///< Thread which fills pages
+	pthread_mutex_t     mutex;      ///< Lock for the fields above
+	pthread_cond_t      cond;       ///< Signalled when a page is filled or freed
+	SerdUring*          ring;       ///< Ring for reading a file, or NULL
+	int64_t             offset;     ///< File offset of the next page to read
+	int64_t             end;        ///< File offset of the end of pages read
+};
+
+static void*
+serd_read_ahead_run(void* arg)
+{
+	SerdReadAhead* const ahead = (SerdReadAhead*)arg;
+
+	pthread_mutex_lock(&ahead->mutex);
+	while (!ahead->stop && !ahead->done) {
+		if (ahead->n_full + ahead->reading == ahead->n_pages) {
+			pthread_cond_wait(&ahead->cond, &ahead->mutex);
+			continue;
+		}
+
+		Page* const page = &ahead->pages[ahead->head];
+		pthread_mutex_unlock(&ahead->mutex);
+
+		const size_t n_read = ahead->read_func(
+			page->buf, 1, ahead->page_size, ahead->stream);
+
+		page->status = SERD_SUCCESS;
+		if (n_read == 0) {
+			page->buf[0] = '\0';
+			page->status = (ahead->error_func(ahead->stream)
+			                ? SERD_ERR_UNKNOWN : SERD_FAILURE);
+			page->error  = errno;
+		} else if (n_read < ahead->page_size) {
+			page->buf[n_read] = '\0';
+		}
+
+		pthread_mutex_lock(&ahead->mutex);
+		ahead->head = (ahead->head + 1) % ahead->n_pages;
+		ahead->done = page->status != SERD_SUCCESS;
+		++ahead->n_full;
+		pthread_cond_broadcast(&ahead->cond);
+	}
+	pthread_mutex_unlock(&ahead->mutex);
+	return NULL;
+}
+
+#ifdef HAVE_IO_URING
+
+static SerdStatus
+serd_read_ahead_uring_page(SerdByteSource* source)
+{
+	SerdReadAhead* const ahead = source->ahead;
+	Page* const          page  = &ahead->pages[ahead->tail];
+
+	if (!ahead->done) {
+		if (ahead->reading) {
+			// Release the previous page by reading a later one into it
+			const unsigned n    = ahead->n_pages;
+			const unsigned prev = (ahead->tail + n - 1) % n;
+			serd_uring_submit(
+				ahead->ring, prev, false, ahead->page_size, ahead->offset);
+			ahead->offset += (int64_t)ahead->page_size;
+		}
+
+		const int64_t n_read = serd_uring_wait(ahead->ring, ahead->tail);
+
+		page->status = SERD_SUCCESS;
+		if (n_read <= 0) {
+			page->buf[0] = '\0';
+			page->status = n_read ? SERD_ERR_UNKNOWN : SERD_FAILURE;
+		} else {
+			ahead->end += n_read;
+			if ((size_t)n_read < ahead->page_size) {
+				page->buf[n_read] = '\0';
+			}
+		}
+
+		if (page->status) {
+			ahead->done = true;
+		} else {
+			ahead->tail    = (ahead->tail + 1) % ahead->n_pages;
+			ahead->reading = true;
+		}
+	}
+
+	source->read_buf = page->buf;
+	source->eof      = page->status != SERD_SUCCESS;
+	return page->status;
+}
+
+/** Start reading a regular file with io_uring, or return NULL. */
+static SerdReadAhead*
+serd_read_ahead_new_uring(FILE* file, size_t page_size, unsigned n_pages)
+{
+	struct stat st;
+	const int   fd     = fileno(file);
+	const off_t offset = ftello(file);
+	if (fd < 0 || fstat(fd, &st) || !S_ISREG(st.st_mode) || offset < 0) {
+		return NULL;
+	}
+
+	SerdUring* const ring = serd_uring_new(fd, n_pages, page_size);
+	if (!ring) {
+		return NULL;
+	}
+
+	SerdReadAhead* const ahead = (SerdReadAhead*)calloc(1, sizeof(*ahead));
+	ahead->stream    = file;
+	ahead->page_size = page_size;
+	ahead->pages     = (Page*)calloc(n_pages, sizeof(Page));
+	ahead->n_pages   = n_pages;
+	ahead->ring      = ring;
+	ahead->offset    = (int64_t)offset;
+	ahead->end       = (int64_t)offset;
+	for (unsigned i = 0; i < n_pages; ++i) {
+		ahead->pages[i].buf = serd_uring_buf(ring, i);
+		serd_uring_submit(ring, i, false, page_size, ahead->offset);
+		ahead->offset += (int64_t)page_size;
+	}
+
+	return ahead;
+}
+
+#endif  // HAVE_IO_URING
+
+static SerdStatus
+serd_read_ahead_page(SerdByteSource* source)
+{
+	SerdReadAhead* const ahead = source->ahead;
+
+#ifdef HAVE_IO_URING
+	if (ahead->ring) {
+		return serd_read_ahead_uring_page(source);
+	}
+#endif
+
+	pthread_mutex_lock(&ahead->mutex);
+	ahead->reading = false;  // Release the previous page
+	pthread_cond_broadcast(&ahead->cond);
+	while (!ahead->n_full) {
+		pthread_cond_wait(&ahead->cond, &ahead->mutex);
+	}
+
+	const Page* const page = &ahead->pages[ahead->tail];
+	if (!page->status) {
+		ahead->tail    = (ahead->tail + 1) % ahead->n_pages;
+		ahead->reading = true;
+		--ahead->n_full;
+	}
+	pthread_mutex_unlock(&ahead->mutex);
+
+	if (page->status > SERD_FAILURE) {
+		errno = page->error;  // Set in the thread, so not visible here
+	}
+
+	source->read_buf = page->buf;
+	source->eof      = page->status != SERD_SUCCESS;
+	return page->status;
+}
+
+static void
+serd_read_ahead_free(SerdReadAhead* ahead)
+{
+#ifdef HAVE_IO_URING
+	if (ahead->ring) {
+		// Leave the file where reading stopped, like reading it directly
+		serd_uring_free(ahead->ring);
+		fseeko((FILE*)ahead->stream, (off_t)ahead->end, SEEK_SET);
+		free(ahead->pages);
+		free(ahead);
+		return;
+	}
+#endif
+
+	for (unsigned i = 0; i < ahead->n_pages; ++i) {
+		free(ahead->pages[i].buf);
+	}
+	free(ahead->pages);
+	free(ahead);
+}
+
+#endif  // HAVE_PTHREAD
+
+size_t
+serd_file_page_size(FILE* file, bool input)
+{
+	size_t size = SERD_PAGE_SIZE;
+#if defined(HAVE_FSTAT) && defined(HAVE_FILENO)
+	struct stat st;
+	const int   fd = fileno(file);
+	if (fd >= 0 && !fstat(fd, &st) && st.st_blksize > 0) {
+		// Several blocks at once, but no more than needed to read a file
+		const size_t block = (size_t)st.st_blksize;
+		size = block * 16;
+		if (input && S_ISREG(st.st_mode) && (uintmax_t)st.st_size < size) {
+			size = ((size_t)st.st_size + block) / block * block;
+		}
+	}
+#else
+	(void)file;
+	(void)input;
+#endif
+
+	return (size < SERD_PAGE_SIZE ? SERD_PAGE_SIZE
+	        : size > SERD_PAGE_SIZE_MAX ? SERD_PAGE_SIZE_MAX
+	        : size);
+}
+
+void
+serd_byte_source_update_cursor(SerdByteSource* source)
+{
+	if (source->from_stream && source->page_size <= 1) {
+		return;  // Updated by serd_byte_source_advance()
+	}
+
+	const uint8_t*       p   = source->read_buf + source->cur_head;
+	const uint8_t* const end = source->read_buf + source->read_head;
+	source->cur.offset += source->read_head - source->cur_head;
+	for (const uint8_t* l; (l = (const uint8_t*)memchr(p, '\n', end - p));) {
+		++source->cur.line;
+		source->cur.col = 0;
+		p               = l + 1;
+	}
+
+	// Null bytes past the end of input do not count
+	source->cur.col += (unsigned)(end - p);
+	for (; (p = (const uint8_t*)memchr(p, '\0', end - p)); ++p) {
+		--source->cur.col;
+	}
+
+	source->cur_head = source->read_head;
+}
+
 SerdStatus
 serd_byte_source_page(SerdByteSource* source)
 {
+	serd_byte_source_update_cursor(source);
 	source->read_head = 0;
+	source->cur_head  = 0;
+	if (source->mapped) {
+		// Reached the end of the mapping, continue like a terminated string
+		source->from_stream = false;
+		source->page_size   = 0;
+		source->read_buf    = (const uint8_t*)"";
+		return SERD_SUCCESS;
+	}
+
+#ifdef HAVE_PTHREAD
+	if (source->ahead) {
+		return serd_read_ahead_page(source);
+	}
+#endif
+
 	const size_t n_read = source->read_func(
 		source->file_buf, 1, source->page_size, source->stream);
 	if (n_read == 0) {
@@ -33,6 +324,116 @@ serd_byte_source_page(SerdByteSource* source)
 	return SERD_SUCCESS;
 }
 
+/// Update `skip` after the byte `c`, which is not a newline
+static void
+skip_byte(SkipState* skip, uint8_t c)
+{
+	if (skip->escaped) {
+		skip->escaped = false;
+	} else if (skip->n_quotes && !skip->long_string) {
+		// After opening quotes, which may start a long or empty string
+		if (c == skip->close) {
+			if (++skip->n_quotes == 3) {
+				skip->long_string = true;
+				skip->n_quotes    = 0;
+			}
+		} else {
+			skip->close    = skip->n_quotes == 2 ? 0 : skip->close;
+			skip->n_quotes = 0;
+			skip_byte(skip, c);
+		}
+	} else if (skip->long_string) {
+		if (c == '\\') {
+			skip->escaped  = true;
+			skip->n_quotes = 0;
+		} else if (c != skip->close) {
+			skip->n_quotes = 0;
+		} else if (++skip->n_quotes == 3) {
+			skip->last        = c;
+			skip->close       = 0;
+			skip->n_quotes    = 0;
+			skip->long_string = false;
+		}
+	} else if (skip->close) {
+		if (c == skip->close) {
+			skip->last  = c;
+			skip->close = 0;
+		} else if (c == '\\' && (skip->close == '"' || skip->close == '\'')) {
+			skip->escaped = true;
+		}
+	} else if (c == '"' || c == '\'') {
+		skip->last     = c;
+		skip->close    = c;
+		skip->n_quotes = 1;
+	} else if (c == '<') {
+		skip->last  = c;
+		skip->close = '>';
+	} else if (c == '#') {
+		skip->close = '\n';
+	} else if (c == '\\') {
+		skip->last    = c;
+		skip->escaped = true;
+	} else if (c == '[' || c == '(' || c == '{') {
+		skip->last = c;
+		++skip->depth;
+	} else if (c == ']' || c == ')' || c == '}') {
+		skip->last   = c;
+		skip->depth -= (skip->depth > 0);
+	} else if (c != ' ' && c != '\t' && c != '\r') {
+		skip->last = c;
+	}
+}
+
+static void
+scan_skipped(SkipState* skip, const uint8_t* buf, size_t len)
+{
+	if (skip) {
+		for (size_t i = 0; i < len; ++i) {
+			skip_byte(skip, buf[i]);
+		}
+	}
+}
+
+uint8_t
+serd_byte_source_skip_to(SerdByteSource* source, uint8_t byte, SkipState* skip)
+{
+	if (source->from_stream && source->page_size <= 1) {
+		// Bytes are read one at a time, so there is nothing to search
+		uint8_t c = 0;
+		while ((c = serd_byte_source_peek(source)) && c != byte) {
+			scan_skipped(skip, &c, 1);
+			if (serd_byte_source_advance(source) > SERD_FAILURE) {
+				return 0;
+			}
+		}
+		return c;
+	}
+
+	while (true) {
+		// Search the rest of the page for the byte or the end of input
+		const uint8_t* const start = source->read_buf + source->read_head;
+		const size_t         n     = source->page_size - source->read_head;
+		const uint8_t* const found = (const uint8_t*)memchr(start, byte, n);
+		const size_t         len   = found ? (size_t)(found - start) : n;
+		const uint8_t* const end   = (const uint8_t*)memchr(start, 0, len);
+		if (end || found) {
+			const size_t n_skip = end ? (size_t)(end - start) : len;
+			scan_skipped(skip, start, n_skip);
+			source->read_head += n_skip;
+			return end ? 0 : byte;
+		}
+
+		scan_skipped(skip, start, n);
+		if (!source->from_stream) {
+			source->read_head = source->page_size;  // At the terminator
+			return 0;
+		} else if (serd_byte_source_skip(source, n) > SERD_FAILURE ||
+		           source->eof) {
+			return 0;
+		}
+	}
+}
+
 SerdStatus
 serd_byte_source_open_source(SerdByteSource*     source,
                              SerdSource          read_func,
@@ -41,7 +442,7 @@ serd_byte_source_open_source(SerdByteSource*     source,
                              const uint8_t*      name,
                              size_t              page_size)
 {
-	const Cursor cur = { name, 1, 1 };
+	const Cursor cur = { name, 1, 1, 0 };
 
 	memset(source, '\0', sizeof(*source));
 	source->stream      = stream;
@@ -66,10 +467,11 @@ SerdStatus
 serd_byte_source_prepare(SerdByteSource* source)
 {
 	source->prepared = true;
-	if (source->from_stream) {
+	if (source->from_stream && !source->mapped) {
 		if (source->page_size > 1) {
 			return serd_byte_source_page(source);
 		} else if (source->from_stream) {
+			--source->cur.offset;  // Not past a byte, this reads the first one
 			return serd_byte_source_advance(source);
 		}
 	}
@@ -79,20 +481,161 @@ serd_byte_source_prepare(SerdByteSource* source)
 SerdStatus
 serd_byte_source_open_string(SerdByteSource* source, const uint8_t* utf8)
 {
-	const Cursor cur = { (const uint8_t*)"(string)", 1, 1 };
+	const Cursor cur = { (const uint8_t*)"(string)", 1, 1, 0 };
+
+	memset(source, '\0', sizeof(*source));
+	source->cur       = cur;
+	source->page_size = strlen((const char*)utf8);
+	source->read_buf  = utf8;
+	return SERD_SUCCESS;
+}
+
+SerdStatus
+serd_byte_source_open_range(SerdByteSource* source,
+                            const uint8_t*  buf,
+                            size_t          size,
+                            const uint8_t*  name)
+{
+	assert(size > 1);
+
+	const Cursor cur = { name, 1, 1, 0 };
 
 	memset(source, '\0', sizeof(*source));
-	source->cur      = cur;
-	source->read_buf = utf8;
+	source->cur         = cur;
+	source->page_size   = size;
+	source->read_buf    = buf;
+	source->from_stream = true;
+	source->mapped      = true;
+	return SERD_SUCCESS;
+}
+
+SerdStatus
+serd_byte_source_open_mapping(SerdByteSource* source,
+                              FILE*           file,
+                              const uint8_t*  name)
+{
+#if defined(HAVE_MMAP) && defined(HAVE_FSTAT) && defined(HAVE_FILENO)
+	/* Only map regular files from the very start, the mapping is read like a
+	   single page so the file must be at least 2 bytes (a 1 byte page is
+	   treated as unbuffered reading by serd_byte_source_advance()). */
+	struct stat st;
+	const int   fd = fileno(file);
+	if (fd < 0 || fstat(fd, &st) || !S_ISREG(st.st_mode) ||
+	    st.st_size < 2 || (uintmax_t)st.st_size > SIZE_MAX ||
+	    ftell(file) != 0) {
+		return SERD_FAILURE;
+	}
+
+	const size_t size = (size_t)st.st_size;
+	void* const  map  = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (map == MAP_FAILED) {
+		return SERD_FAILURE;
+	}
+
+#ifdef HAVE_POSIX_MADVISE
+	posix_madvise(map, size, POSIX_MADV_SEQUENTIAL);
+#endif
+#ifdef MADV_HUGEPAGE
+	madvise(map, size, MADV_HUGEPAGE);
+#endif
+
+	serd_byte_source_open_range(source, (const uint8_t*)map, size, name);
+	source->map      = map;
+	source->map_size = size;
 	return SERD_SUCCESS;
+#else
+	(void)source;
+	(void)file;
+	(void)name;
+	return SERD_FAILURE;
+#endif
+}
+
+SerdStatus
+serd_byte_source_start_read_ahead(SerdByteSource* source, unsigned n_pages)
+{
+#ifdef HAVE_PTHREAD
+	if (!source->from_stream || source->mapped || source->prepared ||
+	    source->page_size <= 1 || n_pages < 2) {
+		return SERD_FAILURE;
+	}
+
+#ifdef HAVE_IO_URING
+	if (source->read_func == (SerdSource)fread &&
+	    (source->ahead = serd_read_ahead_new_uring(
+		    (FILE*)source->stream, source->page_size, n_pages))) {
+		free(source->file_buf);
+		source->file_buf = NULL;
+		source->read_buf = (const uint8_t*)"";
+		return SERD_SUCCESS;
+	}
+#endif
+
+	SerdReadAhead* const ahead = (SerdReadAhead*)calloc(1, sizeof(*ahead));
+	ahead->read_func  = source->read_func;
+	ahead->error_func = source->error_func;
+	ahead->stream     = source->stream;
+	ahead->page_size  = source->page_size;
+	ahead->pages      = (Page*)calloc(n_pages, sizeof(Page));
+	ahead->n_pages    = n_pages;
+	for (unsigned i = 0; i < n_pages; ++i) {
+		if (!(ahead->pages[i].buf = (uint8_t*)serd_bufalloc(ahead->page_size))) {
+			serd_read_ahead_free(ahead);
+			return SERD_ERR_UNKNOWN;
+		}
+	}
+
+	pthread_mutex_init(&ahead->mutex, NULL);
+	pthread_cond_init(&ahead->cond, NULL);
+	if (pthread_create(&ahead->thread, NULL, serd_read_ahead_run, ahead)) {
+		pthread_cond_destroy(&ahead->cond);
+		pthread_mutex_destroy(&ahead->mutex);
+		serd_read_ahead_free(ahead);
+		return SERD_ERR_UNKNOWN;
+	}
+
+	// Pages are read into the ring, so the page buffer is no longer needed
+	free(source->file_buf);
+	source->file_buf = NULL;
+	source->read_buf = (const uint8_t*)"";
+	source->ahead    = ahead;
+	return SERD_SUCCESS;
+#else
+	(void)source;
+	(void)n_pages;
+	return SERD_FAILURE;
+#endif
 }
 
 SerdStatus
 serd_byte_source_close(SerdByteSource* source)
 {
-	if (source->page_size > 1) {
+#ifdef HAVE_PTHREAD
+	SerdReadAhead* const ahead = source->ahead;
+	if (ahead && ahead->ring) {
+		serd_read_ahead_free(ahead);
+	} else if (ahead) {
+		pthread_mutex_lock(&ahead->mutex);
+		ahead->stop = true;
+		pthread_cond_broadcast(&ahead->cond);
+		pthread_mutex_unlock(&ahead->mutex);
+		pthread_join(ahead->thread, NULL);
+		pthread_cond_destroy(&ahead->cond);
+		pthread_mutex_destroy(&ahead->mutex);
+		serd_read_ahead_free(ahead);
+	}
+#endif
+
+	if (source->mapped) {
+#if defined(HAVE_MMAP) && defined(HAVE_FSTAT) && defined(HAVE_FILENO)
+		if (source->map) {
+			munmap(source->map, source->map_size);
+		}
+#endif
+	} else if (source->page_size > 1) {
 		free(source->file_buf);
 	}
+	serd_decoder_free(source->decoder);
 	memset(source, '\0', sizeof(*source));
 	return SERD_SUCCESS;
 }
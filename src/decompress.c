@@ -0,0 +1,341 @@
+/*
+  Copyright 2019 David Robillard <http://drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "serd_internal.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_ZLIB
+#    include <zlib.h>
+#endif
+#ifdef HAVE_BZLIB
+#    include <bzlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#    include <zstd.h>
+#endif
+
+/*
+  A decoder reads a compressed file in large blocks and decompresses straight
+  into the pages of the byte source.  Concatenated streams, as written by
+  bgzip, pigz, pbzip2, or zstd with several frames, are read as one.
+*/
+
+struct SerdDecoderImpl {
+	FILE*           file;     ///< Compressed input
+	SerdCompression format;   ///< Compression format of input
+	uint8_t*        in;       ///< Buffer of compressed input
+	size_t          in_size;  ///< Size of `in`
+	size_t          in_head;  ///< Offset of the next input byte in `in`
+	size_t          in_tail;  ///< Offset of the end of input in `in`
+	bool            started;  ///< True iff in the middle of a stream
+	bool            eof;      ///< True iff all input has been read
+	bool            error;    ///< True iff reading or decoding failed
+#ifdef HAVE_ZLIB
+	z_stream        gz;       ///< Gzip stream
+#endif
+#ifdef HAVE_BZLIB
+	bz_stream       bz;       ///< Bzip2 stream
+#endif
+#ifdef HAVE_ZSTD
+	ZSTD_DStream*   zs;       ///< Zstandard stream
+#endif
+};
+
+static const char* const format_names[] = {
+	"uncompressed", "gzip", "bzip2", "zstd"
+};
+
+static const uint8_t gz_magic[]   = { 0x1F, 0x8B, 0x08 };
+static const uint8_t zstd_magic[] = { 0x28, 0xB5, 0x2F, 0xFD };
+static const uint8_t bz_block[]   = { 0x31, 0x41, 0x59, 0x26, 0x53, 0x59 };
+static const uint8_t bz_end[]     = { 0x17, 0x72, 0x45, 0x38, 0x50, 0x90 };
+
+/** Return true iff `buf` matches the start of the bzip2 magic so far. */
+static bool
+bzip2_prefix(const uint8_t* buf, size_t size)
+{
+	return !strncmp((const char*)buf, "BZh", size < 3 ? size : 3) &&
+	       (size < 4 || (buf[3] >= '1' && buf[3] <= '9')) &&
+	       (size <= 4 || !memcmp(buf + 4, bz_block, size - 4) ||
+	        !memcmp(buf + 4, bz_end, size - 4));
+}
+
+SerdCompression
+serd_compression_detect(const uint8_t* buf, size_t size)
+{
+	if (size >= sizeof(gz_magic) && !memcmp(buf, gz_magic, sizeof(gz_magic))) {
+		return SERD_COMPRESSION_GZIP;
+	} else if (size >= sizeof(zstd_magic) &&
+	           !memcmp(buf, zstd_magic, sizeof(zstd_magic))) {
+		return SERD_COMPRESSION_ZSTD;
+	} else if (size >= SERD_MAGIC_SIZE && bzip2_prefix(buf, SERD_MAGIC_SIZE)) {
+		return SERD_COMPRESSION_BZIP2;
+	}
+
+	return SERD_COMPRESSION_NONE;
+}
+
+bool
+serd_compression_incomplete(const uint8_t* buf, size_t size)
+{
+	return (size < sizeof(gz_magic) && !memcmp(buf, gz_magic, size)) ||
+	       (size < sizeof(zstd_magic) && !memcmp(buf, zstd_magic, size)) ||
+	       (size < SERD_MAGIC_SIZE && bzip2_prefix(buf, size));
+}
+
+const char*
+serd_compression_name(SerdCompression format)
+{
+	return format_names[format];
+}
+
+/** Start decoding a stream, or return false if `format` is unsupported. */
+static bool
+serd_decoder_init(SerdDecoder* decoder)
+{
+	switch (decoder->format) {
+	case SERD_COMPRESSION_NONE:
+		return true;
+	case SERD_COMPRESSION_GZIP:
+#ifdef HAVE_ZLIB
+		return inflateInit2(&decoder->gz, 15 + 16) == Z_OK;
+#else
+		return false;
+#endif
+	case SERD_COMPRESSION_BZIP2:
+#ifdef HAVE_BZLIB
+		return BZ2_bzDecompressInit(&decoder->bz, 0, 0) == BZ_OK;
+#else
+		return false;
+#endif
+	case SERD_COMPRESSION_ZSTD:
+#ifdef HAVE_ZSTD
+		return (decoder->zs = ZSTD_createDStream()) &&
+			!ZSTD_isError(ZSTD_initDStream(decoder->zs));
+#else
+		return false;
+#endif
+	}
+
+	return false;
+}
+
+static void
+serd_decoder_end(SerdDecoder* decoder)
+{
+	switch (decoder->format) {
+	case SERD_COMPRESSION_NONE:
+		break;
+	case SERD_COMPRESSION_GZIP:
+#ifdef HAVE_ZLIB
+		inflateEnd(&decoder->gz);
+#endif
+		break;
+	case SERD_COMPRESSION_BZIP2:
+#ifdef HAVE_BZLIB
+		BZ2_bzDecompressEnd(&decoder->bz);
+#endif
+		break;
+	case SERD_COMPRESSION_ZSTD:
+#ifdef HAVE_ZSTD
+		ZSTD_freeDStream(decoder->zs);
+#endif
+		break;
+	}
+}
+
+SerdDecoder*
+serd_decoder_new(FILE*           file,
+                 SerdCompression format,
+                 const uint8_t*  head,
+                 size_t          head_size)
+{
+	SerdDecoder* const decoder = (SerdDecoder*)calloc(1, sizeof(SerdDecoder));
+	decoder->file    = file;
+	decoder->format  = format;
+	decoder->in_size = format ? SERD_DECODER_BUF_SIZE : head_size;
+	decoder->in      = (uint8_t*)malloc(decoder->in_size + 1);
+	if (!decoder->in || !serd_decoder_init(decoder)) {
+		free(decoder->in);
+		free(decoder);
+		return NULL;
+	}
+
+	assert(head_size <= decoder->in_size);
+	memcpy(decoder->in, head, head_size);
+	decoder->in_tail = head_size;
+	return decoder;
+}
+
+/** Read more compressed input, or return false at the end of the file. */
+static bool
+serd_decoder_fill(SerdDecoder* decoder)
+{
+	if (decoder->eof) {
+		return false;
+	}
+
+	decoder->in_head = 0;
+	decoder->in_tail = fread(decoder->in, 1, decoder->in_size, decoder->file);
+	if (decoder->in_tail == 0) {
+		decoder->eof   = true;
+		decoder->error = ferror(decoder->file);
+		return false;
+	}
+
+	return true;
+}
+
+/**
+   Decode some input into `buf`.
+
+   Returns the number of bytes written.  Sets `started` while a stream is
+   incomplete, and `error` if decoding fails.
+*/
+static size_t
+serd_decoder_step(SerdDecoder* decoder, uint8_t* buf, size_t len)
+{
+	uint8_t* const in    = decoder->in + decoder->in_head;
+	const size_t   n_in  = decoder->in_tail - decoder->in_head;
+	size_t         n_out = 0;
+
+	switch (decoder->format) {
+	case SERD_COMPRESSION_NONE:
+		n_out = n_in < len ? n_in : len;
+		memcpy(buf, in, n_out);
+		decoder->in_head += n_out;
+		return n_out;
+
+	case SERD_COMPRESSION_GZIP:
+#ifdef HAVE_ZLIB
+	{
+		z_stream* const gz = &decoder->gz;
+		gz->next_in   = in;
+		gz->avail_in  = n_in > UINT32_MAX ? UINT32_MAX : (uInt)n_in;
+		gz->next_out  = buf;
+		gz->avail_out = len > UINT32_MAX ? UINT32_MAX : (uInt)len;
+
+		const int r = inflate(gz, Z_NO_FLUSH);
+		decoder->in_head += (size_t)(gz->next_in - in);
+		n_out            = (size_t)(gz->next_out - buf);
+		decoder->started = true;
+		if (r == Z_STREAM_END) {
+			decoder->started = false;
+			decoder->error   = inflateReset(gz) != Z_OK;
+		} else if (r != Z_OK) {
+			decoder->error = true;
+		}
+		return n_out;
+	}
+#endif
+		break;
+
+	case SERD_COMPRESSION_BZIP2:
+#ifdef HAVE_BZLIB
+	{
+		bz_stream* const bz = &decoder->bz;
+		bz->next_in   = (char*)in;
+		bz->avail_in  = n_in > UINT32_MAX ? UINT32_MAX : (unsigned)n_in;
+		bz->next_out  = (char*)buf;
+		bz->avail_out = len > UINT32_MAX ? UINT32_MAX : (unsigned)len;
+
+		const int r = BZ2_bzDecompress(bz);
+		decoder->in_head += (size_t)((uint8_t*)bz->next_in - in);
+		n_out            = (size_t)((uint8_t*)bz->next_out - buf);
+		decoder->started = true;
+		if (r == BZ_STREAM_END) {
+			decoder->started = false;
+			BZ2_bzDecompressEnd(bz);
+			decoder->error = BZ2_bzDecompressInit(bz, 0, 0) != BZ_OK;
+		} else if (r != BZ_OK) {
+			decoder->error = true;
+		}
+		return n_out;
+	}
+#endif
+		break;
+
+	case SERD_COMPRESSION_ZSTD:
+#ifdef HAVE_ZSTD
+	{
+		ZSTD_inBuffer  zin  = { in, n_in, 0 };
+		ZSTD_outBuffer zout = { buf, len, 0 };
+
+		const size_t r = ZSTD_decompressStream(decoder->zs, &zout, &zin);
+		decoder->in_head += zin.pos;
+		decoder->started = r != 0;
+		decoder->error   = ZSTD_isError(r);
+		return zout.pos;
+	}
+#endif
+		break;
+	}
+
+	decoder->error = true;
+	return 0;
+}
+
+size_t
+serd_decoder_read(void* buf, size_t size, size_t nmemb, void* stream)
+{
+	SerdDecoder* const decoder = (SerdDecoder*)stream;
+	uint8_t* const     out     = (uint8_t*)buf;
+	const size_t       len     = size * nmemb;
+
+	// Fill the whole page, a short page is only returned at the end
+	size_t n_out = 0;
+	while (n_out < len && !decoder->error) {
+		if (decoder->in_head < decoder->in_tail) {
+			n_out += serd_decoder_step(decoder, out + n_out, len - n_out);
+		} else if (!decoder->format) {
+			// Uncompressed input after the magic bytes, read into the page
+			n_out += fread(out + n_out, 1, len - n_out, decoder->file);
+			decoder->error = ferror(decoder->file);
+			break;
+		} else if (!serd_decoder_fill(decoder)) {
+			// A stream which stops in the middle is truncated
+			decoder->error = decoder->error || decoder->started;
+			break;
+		}
+	}
+
+	if (decoder->error && !ferror(decoder->file)) {
+		errno = EBADMSG;  // Corrupt or truncated, for the reader's message
+	}
+
+	return size ? n_out / size : 0;
+}
+
+int
+serd_decoder_error(void* stream)
+{
+	return ((const SerdDecoder*)stream)->error;
+}
+
+void
+serd_decoder_free(SerdDecoder* decoder)
+{
+	if (decoder) {
+		serd_decoder_end(decoder);
+		free(decoder->in);
+		free(decoder);
+	}
+}
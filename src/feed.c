@@ -0,0 +1,293 @@
+/*
+  Copyright 2019 David Robillard <http://drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "serd_internal.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+  Fed input is scanned for the ends of top-level statements with a small
+  lexer that only knows about the tokens which may contain a terminator
+  (IRIs, strings, and comments) and can stop anywhere.  Everything up to the
+  last complete statement is read in place with the usual parser, so the
+  parser never sees the end of the input in the middle of a statement, and
+  only the incomplete statement at the end is copied to be read later.
+*/
+
+/// True for bytes which may change the lexical state or end a statement
+static const bool feed_special[256] = {
+	['<'] = true, ['"'] = true, ['\''] = true, ['#'] = true, ['\\'] = true,
+	['{'] = true, ['}'] = true, ['.'] = true
+};
+
+/**
+   Scan `buf` from `feed->scanned` and return the end of the last complete
+   statement, or zero.
+
+   A statement ends with a '.', or a '}' which closes a graph, followed by
+   whitespace.  The end returned is the start of the next statement, if it
+   is on a later line, so the parser reads the same whitespace and recovers
+   from errors at the same place as it would when reading the whole input.
+   Scanning stops early if a token needs more bytes to be recognised, and
+   continues from there next time.
+*/
+static size_t
+feed_scan(Feed* feed, const uint8_t* buf, size_t len)
+{
+	size_t end = 0;
+	size_t i   = feed->scanned;
+	while (i < len) {
+		const uint8_t* p = NULL;
+		switch (feed->state) {
+		case FEED_TOP:
+			while (i < len && !feed_special[buf[i]]) {
+				++i;
+			}
+			if (i == len) {
+				break;
+			} else if (buf[i] == '<') {
+				feed->state = FEED_IRI;
+				++i;
+			} else if (buf[i] == '#') {
+				feed->state = FEED_COMMENT;
+				++i;
+			} else if (buf[i] == '{') {
+				++feed->depth;
+				++i;
+			} else if (len - i < 2) {
+				goto out;  // Need the next byte to continue
+			} else if (buf[i] == '\\') {
+				i += 2;  // Escaped character in a prefixed name
+			} else if (buf[i] == '.' || buf[i] == '}') {
+				// A '.' outside a graph or a '}' which closes one may end it
+				const bool last = (buf[i] == '.'
+				                   ? !feed->depth
+				                   : feed->depth && !--feed->depth);
+				++i;
+				if (last && is_space((char)buf[i])) {
+					feed->state = FEED_END;
+				}
+			} else if (len - i < 3) {
+				goto out;  // Need the next two bytes to find a long string
+			} else {
+				feed->quote = buf[i];
+				if (buf[i + 1] == buf[i] && buf[i + 2] == buf[i]) {
+					feed->state = FEED_LONG_STRING;
+					i += 3;
+				} else if (buf[i + 1] == buf[i]) {
+					i += 2;  // Empty string
+				} else {
+					feed->state = FEED_STRING;
+					++i;
+				}
+			}
+			break;
+
+		case FEED_END:
+			for (; i < len && is_space((char)buf[i]); ++i) {
+				feed->newline = feed->newline || buf[i] == '\n';
+			}
+			if (i == len) {
+				break;
+			} else if (buf[i] == '#') {
+				feed->state = FEED_END_COMMENT;
+				++i;
+			} else {
+				end           = feed->newline ? i : end;
+				feed->state   = FEED_TOP;
+				feed->newline = false;
+			}
+			break;
+
+		case FEED_IRI:
+		case FEED_COMMENT:
+		case FEED_END_COMMENT:
+			p = (const uint8_t*)memchr(
+				buf + i, feed->state == FEED_IRI ? '>' : '\n', len - i);
+			if (!p) {
+				i = len;
+				break;
+			}
+
+			i             = (size_t)(p - buf) + 1;
+			feed->newline = feed->state == FEED_END_COMMENT;
+			feed->state   = feed->newline ? FEED_END : FEED_TOP;
+			break;
+
+		case FEED_STRING:
+		case FEED_LONG_STRING:
+			if (buf[i] == '\\') {
+				if (len - i < 2) {
+					goto out;
+				}
+				i += 2;
+			} else if (buf[i] != feed->quote) {
+				++i;
+			} else if (feed->state == FEED_STRING) {
+				feed->state = FEED_TOP;
+				++i;
+			} else if (len - i < 3) {
+				goto out;
+			} else if (buf[i + 1] == feed->quote && buf[i + 2] == feed->quote) {
+				feed->state = FEED_TOP;
+				i += 3;
+			} else {
+				++i;
+			}
+			break;
+		}
+	}
+
+out:
+	feed->scanned = i;
+	return end;
+}
+
+/// Return the end of the last complete line in `buf`, or zero
+static size_t
+feed_scan_lines(Feed* feed, const uint8_t* buf, size_t len)
+{
+	size_t end = len;
+	while (end > feed->scanned && buf[end - 1] != '\n') {
+		--end;
+	}
+
+	feed->scanned = len;
+	return (end && buf[end - 1] == '\n') ? end : 0;
+}
+
+/// Move the cursor past `len` bytes of input
+static void
+feed_advance(Feed* feed, const uint8_t* buf, size_t len)
+{
+	const uint8_t*       p   = buf;
+	const uint8_t* const end = buf + len;
+	for (const uint8_t* l; (l = (const uint8_t*)memchr(p, '\n', end - p));) {
+		++feed->cur.line;
+		feed->cur.col = 0;
+		p             = l + 1;
+	}
+	feed->cur.col    += (unsigned)(end - p);
+	feed->cur.offset += len;
+}
+
+/// Read complete statements at the start of fed input and advance past them
+static SerdStatus
+feed_read(SerdReader* reader, const uint8_t* buf, size_t len)
+{
+	Feed* const feed = &reader->feed;
+
+	// Skipping an error continues from the last read if it ran to the end
+	size_t           n_read = len;
+	const SerdStatus st     = serd_reader_read_range(
+		reader, buf, len, feed->cur, &n_read);
+
+	feed_advance(feed, buf, len);
+
+	// A null byte outside a literal ends the input, like the end of a string
+	return (st || n_read == len) ? st : SERD_FAILURE;
+}
+
+/// Make room for `len` bytes in the feed buffer
+static bool
+feed_reserve(Feed* feed, size_t len)
+{
+	if (feed->size < len) {
+		const size_t   size = len > 2 * feed->size ? len : 2 * feed->size;
+		uint8_t* const buf  = (uint8_t*)realloc(feed->buf, size);
+		if (!buf) {
+			return false;
+		}
+		feed->buf  = buf;
+		feed->size = size;
+	}
+	return true;
+}
+
+SerdStatus
+serd_reader_feed(SerdReader* reader, const uint8_t* buf, size_t len)
+{
+	Feed* const feed = &reader->feed;
+	if (feed->status) {
+		return feed->status;  // Stopped, like reading a document would
+	} else if (!feed->cur.line) {
+		feed->cur = serd_reader_start_cursor(reader, (const uint8_t*)"(feed)");
+		reader->skipping    = false;
+		reader->error_ended = false;
+		memset(&reader->skip, '\0', sizeof(SkipState));
+		reader->sink_failed = false;
+	}
+
+	// Append to the incomplete statement from last time, or read in place
+	const uint8_t* input = buf;
+	size_t         size  = len;
+	if (feed->len) {
+		if (!feed_reserve(feed, feed->len + len)) {
+			return SERD_ERR_UNKNOWN;
+		}
+		memcpy(feed->buf + feed->len, buf, len);
+		input = feed->buf;
+		size  = feed->len += len;
+	}
+
+	const bool line_based = (reader->syntax == SERD_NTRIPLES ||
+	                         reader->syntax == SERD_NQUADS);
+
+	const size_t end = (line_based ? feed_scan_lines(feed, input, size)
+	                               : feed_scan(feed, input, size));
+
+	const SerdStatus st = end ? feed_read(reader, input, end) : SERD_SUCCESS;
+
+	// Keep the rest for next time, unless reading has stopped
+	const size_t rest = st ? 0 : size - end;
+	if (input == feed->buf) {
+		memmove(feed->buf, feed->buf + end, rest);
+	} else if (!feed_reserve(feed, rest)) {
+		return SERD_ERR_UNKNOWN;
+	} else if (rest) {
+		memcpy(feed->buf, input + end, rest);
+	}
+	feed->len     = rest;
+	feed->scanned = rest ? feed->scanned - end : 0;
+	feed->status  = st;
+
+	const SerdStatus bst = serd_reader_flush_batch(reader);
+	return st ? st : bst;
+}
+
+SerdStatus
+serd_reader_finish(SerdReader* reader)
+{
+	Feed* const feed = &reader->feed;
+	SerdStatus  st   = feed->status > SERD_FAILURE ? feed->status : SERD_SUCCESS;
+	if (!feed->status && feed->len &&
+	    (st = feed_read(reader, feed->buf, feed->len)) == SERD_FAILURE) {
+		st = SERD_SUCCESS;
+	}
+
+	// Reset to read another document, but keep the buffer
+	uint8_t* const buf  = feed->buf;
+	const size_t   size = feed->size;
+	memset(feed, '\0', sizeof(Feed));
+	feed->buf  = buf;
+	feed->size = size;
+
+	const SerdStatus bst = serd_reader_flush_batch(reader);
+	return st ? st : bst;
+}
@@ -0,0 +1,139 @@
+#!/usr/bin/env python
+
+"""Generate the character class tables used for reading names.
+
+Writes a C header to stdout with a class table for every byte, and a
+two-level bitmap of the PN_CHARS_BASE and PN_CHARS code points from the
+Turtle grammar, with one bitmap page for every 256 code points.
+"""
+
+import sys
+
+# Class bits for single bytes, with the bytes in each class
+BYTE_CLASSES = [
+    ('ALPHA', 'ALPHA',
+     lambda c: chr(c).isalpha() and c < 0x80),
+    ('PN_CHARS', 'ASCII PN_CHARS',
+     lambda c: c < 0x80 and (chr(c).isalnum() or chr(c) in '_-')),
+    ('DOT', '`.\'',
+     lambda c: chr(c) == '.'),
+    ('COLON', '`:\'',
+     lambda c: chr(c) == ':'),
+    ('PLX', 'Start of PLX (`%\' or `\\\\\')',
+     lambda c: chr(c) in '%\\'),
+    ('UTF8', 'Part of a multi-byte UTF-8 character',
+     lambda c: c >= 0x80)]
+
+# [163s] PN_CHARS_BASE (without ASCII)
+PN_CHARS_BASE = [(0x00C0, 0x00D6), (0x00D8, 0x00F6), (0x00F8, 0x02FF),
+                 (0x0370, 0x037D), (0x037F, 0x1FFF), (0x200C, 0x200D),
+                 (0x2070, 0x218F), (0x2C00, 0x2FEF), (0x3001, 0xD7FF),
+                 (0xF900, 0xFDCF), (0xFDF0, 0xFFFD), (0x10000, 0xEFFFF)]
+
+# [166s] PN_CHARS (without ASCII), in addition to PN_CHARS_BASE
+PN_CHARS = PN_CHARS_BASE + [(0x00B7, 0x00B7), (0x0300, 0x036F),
+                            (0x203F, 0x2040)]
+
+N_CODES = 0x110000
+PAGE_SIZE = 256
+WORD_BITS = 32
+
+
+def code_bits(ranges):
+    "Return a list of whether each code point is in one of `ranges`"
+    bits = [False] * N_CODES
+    for first, last in ranges:
+        for c in range(first, last + 1):
+            bits[c] = True
+    return bits
+
+
+def page_words(bits, page):
+    "Return the bitmap words for a page of code points"
+    words = []
+    start = page * PAGE_SIZE
+    for w in range(start, start + PAGE_SIZE, WORD_BITS):
+        word = 0
+        for b in range(WORD_BITS):
+            if bits[w + b]:
+                word |= 1 << b
+        words += [word]
+    return words
+
+
+def write_words(out, words):
+    out.write('\t\t{ %s,\n' % ', '.join(
+        ['0x%08X' % w for w in words[0:4]]))
+    out.write('\t\t  %s },\n' % ', '.join(
+        ['0x%08X' % w for w in words[4:8]]))
+
+
+def main(out):
+    out.write('/* Generated by gen_char_classes.py, do not edit */\n\n')
+    out.write('#ifndef SERD_CHAR_CLASSES_H\n')
+    out.write('#define SERD_CHAR_CLASSES_H\n\n')
+    out.write('#include <stdint.h>\n\n')
+
+    # Byte classes
+    width = max([len(name) for name, _, _ in BYTE_CLASSES])
+    out.write('/** Class bits for a byte in serd_char_classes. */\n')
+    out.write('typedef enum {\n')
+    for i, (name, doc, _) in enumerate(BYTE_CLASSES):
+        out.write('\tSERD_CHAR_%s = 1 << %d,  ///< %s\n' % (
+            name.ljust(width), i, doc))
+    out.write('} SerdCharClass;\n\n')
+
+    out.write('/** Classes of every byte, a set of SerdCharClass bits. */\n')
+    out.write('static const uint8_t serd_char_classes[256] = {\n')
+    for row in range(0, 256, 8):
+        out.write('\t%s,\n' % ', '.join(
+            ['0x%02X' % sum([1 << i
+                             for i, (_, _, pred) in enumerate(BYTE_CLASSES)
+                             if pred(c)])
+             for c in range(row, row + 8)]))
+    out.write('};\n\n')
+
+    # Name code point bitmaps, with identical pages shared
+    base_bits  = code_bits(PN_CHARS_BASE)
+    chars_bits = code_bits(PN_CHARS)
+    pages      = []
+    index      = []
+    for page in range(N_CODES // PAGE_SIZE):
+        words = (page_words(base_bits, page), page_words(chars_bits, page))
+        if words not in pages:
+            pages += [words]
+        index += [pages.index(words)]
+
+    out.write('/** Bitmaps for each page in serd_name_pages. */\n')
+    out.write('typedef enum {\n')
+    out.write('\tSERD_NAME_PN_CHARS_BASE = 0,  ///< PN_CHARS_BASE\n')
+    out.write('\tSERD_NAME_PN_CHARS      = 1   ///< PN_CHARS\n')
+    out.write('} SerdNameBitmap;\n\n')
+
+    out.write('/** Number of code points in a page of name bitmaps. */\n')
+    out.write('#define SERD_NAME_PAGE_SIZE %dU\n\n' % PAGE_SIZE)
+
+    out.write('/** Page of serd_name_pages for each page of code points. */\n')
+    out.write('static const uint8_t serd_name_page_index[%d] = {\n' %
+              len(index))
+    for row in range(0, len(index), 16):
+        out.write('\t%s,\n' % ', '.join(
+            ['%d' % i for i in index[row:row + 16]]))
+    out.write('};\n\n')
+
+    out.write('/** PN_CHARS_BASE and PN_CHARS bitmaps for pages of code '
+              'points. */\n')
+    out.write('static const uint32_t serd_name_pages[%d][2][%d] = {\n' % (
+        len(pages), PAGE_SIZE // WORD_BITS))
+    for base, chars in pages:
+        out.write('\t{\n')
+        write_words(out, base)
+        write_words(out, chars)
+        out.write('\t},\n')
+    out.write('};\n\n')
+
+    out.write('#endif  // SERD_CHAR_CLASSES_H\n')
+
+
+if __name__ == '__main__':
+    main(sys.stdout)
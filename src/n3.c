@@ -24,6 +24,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "char_classes.h"
 #include "reader.h"
 
 #define TRY_THROW(exp) if (!(exp)) goto except;
@@ -41,6 +42,177 @@ read_collection(SerdReader* reader, ReadContext ctx, Ref* dest);
 static bool
 read_predicateObjectList(SerdReader* reader, ReadContext ctx, bool* ate_dot);
 
+/**
+   Return the number of input bytes that may be read as a node view.
+
+   When validating, nodes are not passed on, so a view may point into the
+   current page even though it is replaced later.  A view never ends at the
+   end of the page, so the page is not replaced while reading it, and the
+   view can be used until more is read.
+*/
+static inline size_t
+view_limit(SerdReader* reader)
+{
+	if (reader->validating) {
+		const size_t available = serd_byte_source_available(&reader->source);
+		return available ? available - 1 : 0;
+	}
+
+	return (reader->node_views
+	        ? serd_byte_source_stable_size(&reader->source)
+	        : 0);
+}
+
+/** Return true iff `c` is an ASCII PN_CHARS character. */
+static inline bool
+is_PN_CHARS_ascii(const uint8_t c)
+{
+	return serd_char_classes[c] & SERD_CHAR_PN_CHARS;
+}
+
+/** Return true iff code point `c` is in name bitmap `which`. */
+static inline bool
+in_name_bitmap(const uint32_t c, const SerdNameBitmap which)
+{
+	if (c >= 0x110000) {
+		return false;
+	}
+
+	const uint32_t* const bits =
+		serd_name_pages[serd_name_page_index[c / SERD_NAME_PAGE_SIZE]][which];
+
+	return (bits[(c % SERD_NAME_PAGE_SIZE) / 32] >> (c % 32)) & 1;
+}
+
+/**
+   Scan a buffered multi-byte character in name bitmap `which`.
+
+   Returns the size of the character, or zero if it is not entirely in `str`
+   or would not be read as a name character without error.
+*/
+static inline size_t
+scan_name_utf8(const uint8_t* str, size_t len, const SerdNameBitmap which)
+{
+	const size_t size = utf8_num_bytes(str[0]);
+	if (size < 2 || size > len) {
+		return 0;
+	}
+
+	for (size_t i = 1; i < size; ++i) {
+		if (!(str[i] & 0x80)) {
+			return 0;
+		}
+	}
+
+	return in_name_bitmap(parse_counted_utf8_char(str, size), which) ? size : 0;
+}
+
+/**
+   Scan the first character of a name.
+
+   This accepts an ASCII character in `classes`, or a multi-byte character in
+   name bitmap `which`, and adds the number of ASCII characters to `n_ascii`.
+*/
+static inline size_t
+scan_name_start(const uint8_t*       str,
+                size_t               len,
+                const unsigned       classes,
+                const SerdNameBitmap which,
+                size_t*              n_ascii)
+{
+	if (!len) {
+		return 0;
+	} else if (serd_char_classes[str[0]] & classes) {
+		++*n_ascii;
+		return 1;
+	}
+
+	return (str[0] & 0x80) ? scan_name_utf8(str, len, which) : 0;
+}
+
+/**
+   Scan a run of name characters after the first.
+
+   This accepts ASCII characters in `classes` and multi-byte characters in
+   name bitmap `which`, and adds the number of ASCII characters to `n_ascii`.
+*/
+static inline size_t
+scan_name_run(const uint8_t*       str,
+              size_t               len,
+              const unsigned       classes,
+              const SerdNameBitmap which,
+              size_t*              n_ascii)
+{
+	size_t n      = 0;
+	size_t n_utf8 = 0;
+	for (size_t size = 0;; n += size, n_utf8 += size) {
+		while (n < len && (serd_char_classes[str[n]] & classes)) {
+			++n;
+		}
+
+		if (n == len || !(str[n] & 0x80) ||
+		    !(size = scan_name_utf8(str + n, len - n, which))) {
+			break;
+		}
+	}
+
+	*n_ascii += n - n_utf8;
+	return n;
+}
+
+/**
+   Scan the body of a string literal for a view, or return false.
+
+   This accepts exactly the strings that would be read without any escapes,
+   and sets `flags` and `n_chars` like reading the string character by
+   character would.  Plain runs of valid UTF-8 are scanned in one step.
+*/
+static inline bool
+scan_string_char(const uint8_t* str,
+                 size_t         limit,
+                 size_t*        n,
+                 size_t*        n_chars,
+                 SerdNodeFlags* flags)
+{
+	const size_t run = serd_scan_utf8(str + *n, limit - *n, false, n_chars);
+	if (run) {
+		*n += run;
+		return true;
+	}
+
+	const uint8_t c = str[*n];
+	switch (c) {
+	case '\0': case '\\':
+		return false;
+	case '\n': case '\r':
+		*flags |= SERD_HAS_NEWLINE;
+		break;
+	case '"': case '\'':
+		*flags |= SERD_HAS_QUOTE;
+		break;
+	}
+
+	if (!(c & 0x80)) {
+		++*n;
+		++*n_chars;
+		return true;
+	}
+
+	const uint32_t size = utf8_num_bytes(c);
+	if (size <= 1 || size > 4 || *n + size > limit) {
+		return false;
+	}
+
+	for (uint32_t i = 1; i < size; ++i) {
+		if (!(str[*n + i] & 0x80)) {
+			return false;
+		}
+	}
+
+	*n += size;
+	return true;
+}
+
 static inline uint8_t
 read_HEX(SerdReader* reader)
 {
@@ -250,6 +422,15 @@ static void
 read_comment(SerdReader* reader)
 {
 	eat_byte_safe(reader, '#');
+
+	// Skip the comment text in memory in bulk, a page at a time
+	size_t n = 0;
+	while ((n = serd_scan_comment(
+		        peek_bytes(reader),
+		        serd_byte_source_available(&reader->source)))) {
+		skip_bytes(reader, n);
+	}
+
 	uint8_t c;
 	while (((c = peek_byte(reader)) != 0xA) && (c != 0xD) && c) {
 		eat_byte_safe(reader, c);
@@ -273,10 +454,25 @@ read_ws(SerdReader* reader)
 	}
 }
 
+// Skip a run of whitespace in memory in bulk
+static void
+skip_ws_run(SerdReader* reader)
+{
+	const size_t n = serd_scan_ws(
+		peek_bytes(reader), serd_byte_source_available(&reader->source));
+	if (n) {
+		skip_bytes(reader, n);
+	}
+}
+
 static inline bool
 read_ws_star(SerdReader* reader)
 {
-	while (read_ws(reader)) {}
+	while (read_ws(reader)) {
+		if (is_space(peek_byte(reader))) {
+			skip_ws_run(reader);
+		}
+	}
 	return true;
 }
 
@@ -297,13 +493,193 @@ eat_delim(SerdReader* reader, const char delim)
 	return false;
 }
 
+// Read a short string without escapes as a view, or return zero
+static Ref
+read_STRING_LITERAL_view(SerdReader* reader, SerdNodeFlags* flags, uint8_t q)
+{
+	const size_t         limit   = view_limit(reader);
+	const uint8_t* const str     = peek_bytes(reader);
+	size_t               n       = 0;
+	size_t               n_chars = 0;
+	SerdNodeFlags        f       = 0;
+	while (n < limit && str[n] != q) {
+		if (str[n] == '\n' || str[n] == '\r' ||
+		    !scan_string_char(str, limit, &n, &n_chars, &f)) {
+			return 0;
+		}
+	}
+
+	if (n == limit) {
+		return 0;
+	}
+
+	*flags |= f;
+	const Ref ref = push_node_view(reader, SERD_LITERAL, str, n, n_chars);
+	skip_bytes(reader, n + 1);
+	return ref;
+}
+
+// Read a long string without escapes as a view, or return zero
+static Ref
+read_STRING_LITERAL_LONG_view(SerdReader*    reader,
+                              SerdNodeFlags* flags,
+                              uint8_t        q)
+{
+	const size_t         limit   = view_limit(reader);
+	const uint8_t* const str     = peek_bytes(reader);
+	size_t               n       = 0;
+	size_t               n_chars = 0;
+	SerdNodeFlags        f       = 0;
+	while (n + 2 < limit &&
+	       (str[n] != q || str[n + 1] != q || str[n + 2] != q)) {
+		if (!scan_string_char(str, limit, &n, &n_chars, &f)) {
+			return 0;
+		}
+	}
+
+	if (n + 2 >= limit) {
+		return 0;
+	}
+
+	*flags |= f;
+	const Ref ref = push_node_view(reader, SERD_LITERAL, str, n, n_chars);
+	skip_bytes(reader, n + 3);
+	return ref;
+}
+
+typedef size_t (*ScanFunc)(const uint8_t* str, size_t len);
+
+// Push a run of plain characters in one step, return its length
+static inline size_t
+read_plain_run(SerdReader* reader, Ref ref, ScanFunc scan)
+{
+	const uint8_t* const str = peek_bytes(reader);
+	const size_t         n   = scan(
+		str, serd_byte_source_available(&reader->source));
+	if (n) {
+		push_ascii(reader, ref, str, n);
+		skip_bytes(reader, n);
+	}
+	return n;
+}
+
+/**
+   Push a run of plain characters including valid UTF-8 in one step.
+
+   This is used after a run of plain ASCII ends at a non-ASCII byte, and
+   returns zero if the next character is ASCII or must be read on its own.
+*/
+static inline size_t
+read_utf8_run(SerdReader* reader, Ref ref, const bool iri)
+{
+	if (!(peek_byte(reader) & 0x80)) {
+		return 0;
+	}
+
+	const uint8_t* const str     = peek_bytes(reader);
+	const size_t         len     = serd_byte_source_available(&reader->source);
+	size_t               n_ascii = 0;
+	const size_t         n       = serd_scan_utf8(str, len, iri, &n_ascii);
+	if (n) {
+		memcpy(push_reserve(reader, ref, n, n_ascii), str, n);
+		skip_bytes(reader, n);
+	}
+	return n;
+}
+
+// Push a run of ASCII characters accepted by `scan`, including the next one
+static inline void
+read_ascii_run(SerdReader* reader, Ref ref, ScanFunc scan)
+{
+	if (!read_plain_run(reader, ref, scan)) {  // Reading a byte at a time
+		push_byte(reader, ref, eat_byte(reader));
+	}
+}
+
+static size_t
+scan_digits(const uint8_t* str, size_t len)
+{
+	size_t n = 0;
+	while (n < len && is_digit(str[n])) {
+		++n;
+	}
+	return n;
+}
+
+static size_t
+scan_alpha(const uint8_t* str, size_t len)
+{
+	size_t n = 0;
+	while (n < len && is_alpha(str[n])) {
+		++n;
+	}
+	return n;
+}
+
+static size_t
+scan_alnum(const uint8_t* str, size_t len)
+{
+	size_t n = 0;
+	while (n < len && (is_alpha(str[n]) || is_digit(str[n]))) {
+		++n;
+	}
+	return n;
+}
+
+/**
+   Push a run of name characters after the first.
+
+   This reads buffered ASCII characters in `classes` and multi-byte PN_CHARS
+   in one step, or a single ASCII character in `classes` if reading a byte at
+   a time.  Returns the number of bytes read, or zero if the next character
+   must be read on its own.
+*/
+static inline size_t
+read_name_run(SerdReader* reader, Ref ref, const unsigned classes)
+{
+	const uint8_t* const str     = peek_bytes(reader);
+	const size_t         len     = serd_byte_source_available(&reader->source);
+	size_t               n_ascii = 0;
+	const size_t         n       = scan_name_run(
+		str, len, classes, SERD_NAME_PN_CHARS, &n_ascii);
+	if (n) {
+		memcpy(push_reserve(reader, ref, n, n_ascii), str, n);
+		skip_bytes(reader, n);
+	} else if (serd_char_classes[peek_byte(reader)] & classes) {
+		push_byte(reader, ref, eat_byte(reader));
+		return 1;
+	}
+	return n;
+}
+
+// Scan IRI scheme characters, up to the terminating ':'
+static size_t
+scan_IRI_scheme(const uint8_t* str, size_t len)
+{
+	size_t n = 0;
+	while (n < len && str[n] != ':' && is_uri_scheme_char(str[n])) {
+		++n;
+	}
+	return n;
+}
+
 // STRING_LITERAL_LONG_QUOTE and STRING_LITERAL_LONG_SINGLE_QUOTE
 // Initial triple quotes are already eaten by caller
 static Ref
 read_STRING_LITERAL_LONG(SerdReader* reader, SerdNodeFlags* flags, uint8_t q)
 {
-	Ref ref = push_node(reader, SERD_LITERAL, "", 0);
+	Ref ref = read_STRING_LITERAL_LONG_view(reader, flags, q);
+	if (ref) {
+		return ref;
+	}
+
+	ref = push_node(reader, SERD_LITERAL, "", 0);
 	while (!reader->status) {
+		if (read_plain_run(reader, ref, serd_scan_string) ||
+		    read_utf8_run(reader, ref, false)) {
+			continue;
+		}
+
 		const uint8_t c = peek_byte(reader);
 		if (c == '\\') {
 			eat_byte_safe(reader, c);
@@ -337,8 +713,18 @@ read_STRING_LITERAL_LONG(SerdReader* reader, SerdNodeFlags* flags, uint8_t q)
 static Ref
 read_STRING_LITERAL(SerdReader* reader, SerdNodeFlags* flags, uint8_t q)
 {
-	Ref ref = push_node(reader, SERD_LITERAL, "", 0);
+	Ref ref = read_STRING_LITERAL_view(reader, flags, q);
+	if (ref) {
+		return ref;
+	}
+
+	ref = push_node(reader, SERD_LITERAL, "", 0);
 	while (!reader->status) {
+		if (read_plain_run(reader, ref, serd_scan_string) ||
+		    read_utf8_run(reader, ref, false)) {
+			continue;
+		}
+
 		const uint8_t c    = peek_byte(reader);
 		uint32_t      code = 0;
 		switch (c) {
@@ -367,6 +753,17 @@ read_STRING_LITERAL(SerdReader* reader, SerdNodeFlags* flags, uint8_t q)
 	return ref;
 }
 
+/// Return `ref`, or if it is zero, start skipping the error in the token
+static inline Ref
+check_token(SerdReader* reader, Ref ref, uint8_t close, bool long_string)
+{
+	if (!ref) {
+		reader->skip.close       = close;
+		reader->skip.long_string = long_string;
+	}
+	return ref;
+}
+
 static Ref
 read_String(SerdReader* reader, SerdNodeFlags* flags)
 {
@@ -375,7 +772,8 @@ read_String(SerdReader* reader, SerdNodeFlags* flags)
 
 	const uint8_t q2 = peek_byte(reader);
 	if (q2 != q1) {  // Short string (not triple quoted)
-		return read_STRING_LITERAL(reader, flags, q1);
+		return check_token(
+			reader, read_STRING_LITERAL(reader, flags, q1), q1, false);
 	}
 
 	eat_byte_safe(reader, q2);
@@ -390,18 +788,28 @@ read_String(SerdReader* reader, SerdNodeFlags* flags)
 	}
 
 	eat_byte_safe(reader, q3);
-	return read_STRING_LITERAL_LONG(reader, flags, q1);
+	return check_token(
+		reader, read_STRING_LITERAL_LONG(reader, flags, q1), q1, true);
 }
 
 static inline bool
 is_PN_CHARS_BASE(const uint32_t c)
 {
-	return ((c >= 0x00C0 && c <= 0x00D6) || (c >= 0x00D8 && c <= 0x00F6) ||
-	        (c >= 0x00F8 && c <= 0x02FF) || (c >= 0x0370 && c <= 0x037D) ||
-	        (c >= 0x037F && c <= 0x1FFF) || (c >= 0x200C && c <= 0x200D) ||
-	        (c >= 0x2070 && c <= 0x218F) || (c >= 0x2C00 && c <= 0x2FEF) ||
-	        (c >= 0x3001 && c <= 0xD7FF) || (c >= 0xF900 && c <= 0xFDCF) ||
-	        (c >= 0xFDF0 && c <= 0xFFFD) || (c >= 0x10000 && c <= 0xEFFFF));
+	return in_name_bitmap(c, SERD_NAME_PN_CHARS_BASE);
+}
+
+// Push a buffered multi-byte name character in one step, or return false
+static inline bool
+read_name_utf8(SerdReader* reader, Ref dest, const SerdNameBitmap which)
+{
+	const uint8_t* const str  = peek_bytes(reader);
+	const size_t         size = scan_name_utf8(
+		str, serd_byte_source_available(&reader->source), which);
+	if (size) {
+		memcpy(push_reserve(reader, dest, size, 0), str, size);
+		skip_bytes(reader, size);
+	}
+	return size;
 }
 
 static SerdStatus
@@ -414,6 +822,8 @@ read_PN_CHARS_BASE(SerdReader* reader, Ref dest)
 		push_byte(reader, dest, eat_byte_safe(reader, c));
 	} else if (!(c & 0x80)) {
 		return SERD_FAILURE;
+	} else if (read_name_utf8(reader, dest, SERD_NAME_PN_CHARS_BASE)) {
+		return SERD_SUCCESS;
 	} else if ((st = read_utf8_code(reader, dest, &code,
 	                                eat_byte_safe(reader, c)))) {
 		return st;
@@ -430,8 +840,7 @@ read_PN_CHARS_BASE(SerdReader* reader, Ref dest)
 static inline bool
 is_PN_CHARS(const uint32_t c)
 {
-	return (is_PN_CHARS_BASE(c) || c == 0xB7 ||
-	        (c >= 0x0300 && c <= 0x036F) || (c >= 0x203F && c <= 0x2040));
+	return in_name_bitmap(c, SERD_NAME_PN_CHARS);
 }
 
 static SerdStatus
@@ -440,10 +849,12 @@ read_PN_CHARS(SerdReader* reader, Ref dest)
 	uint32_t      code;
 	const uint8_t c = peek_byte(reader);
 	SerdStatus    st = SERD_SUCCESS;
-	if (is_alpha(c) || is_digit(c) || c == '_' || c == '-') {
+	if (is_PN_CHARS_ascii(c)) {
 		push_byte(reader, dest, eat_byte_safe(reader, c));
 	} else if (!(c & 0x80)) {
 		return SERD_FAILURE;
+	} else if (read_name_utf8(reader, dest, SERD_NAME_PN_CHARS)) {
+		return SERD_SUCCESS;
 	} else if ((st = read_utf8_code(reader, dest, &code,
 	                                eat_byte_safe(reader, c)))) {
 		return st;
@@ -457,12 +868,12 @@ read_PN_CHARS(SerdReader* reader, Ref dest)
 static bool
 read_PERCENT(SerdReader* reader, Ref dest)
 {
-	push_byte(reader, dest, eat_byte_safe(reader, '%'));
+	eat_byte_safe(reader, '%');
 	const uint8_t h1 = read_HEX(reader);
 	const uint8_t h2 = read_HEX(reader);
 	if (h1 && h2) {
-		push_byte(reader, dest, h1);
-		push_byte(reader, dest, h2);
+		const uint8_t escape[] = { '%', h1, h2 };
+		push_ascii(reader, dest, escape, sizeof(escape));
 		return true;
 	}
 	return false;
@@ -511,15 +922,20 @@ read_PN_LOCAL(SerdReader* reader, Ref dest, bool* ate_dot)
 		}
 	}
 
+	static const unsigned middle =
+		SERD_CHAR_PN_CHARS | SERD_CHAR_DOT | SERD_CHAR_COLON;
+
 	while ((c = peek_byte(reader))) {  // Middle: (PN_CHARS | '.' | ':')*
-		if (c == '.' || c == ':') {
-			push_byte(reader, dest, eat_byte_safe(reader, c));
+		if (read_name_run(reader, dest, middle)) {
+			const SerdNode* const n = deref(reader, dest);
+			trailing_unescaped_dot  = (n->buf[n->n_bytes - 1] == '.');
+			continue;
 		} else if ((st = read_PLX(reader, dest)) > SERD_FAILURE) {
 			return st;
 		} else if (st != SERD_SUCCESS && (st = read_PN_CHARS(reader, dest))) {
 			break;
 		}
-		trailing_unescaped_dot = (c == '.');
+		trailing_unescaped_dot = false;
 	}
 
 	SerdNode* const n = deref(reader, dest);
@@ -537,10 +953,9 @@ read_PN_LOCAL(SerdReader* reader, Ref dest, bool* ate_dot)
 static SerdStatus
 read_PN_PREFIX_tail(SerdReader* reader, Ref dest)
 {
-	uint8_t c;
-	while ((c = peek_byte(reader))) {  // Middle: (PN_CHARS | '.')*
-		if (c == '.') {
-			push_byte(reader, dest, eat_byte_safe(reader, c));
+	while (peek_byte(reader)) {  // Middle: (PN_CHARS | '.')*
+		if (read_name_run(reader, dest, SERD_CHAR_PN_CHARS | SERD_CHAR_DOT)) {
+			continue;
 		} else if (read_PN_CHARS(reader, dest)) {
 			break;
 		}
@@ -572,14 +987,13 @@ read_LANGTAG(SerdReader* reader)
 		return r_err(reader, SERD_ERR_BAD_SYNTAX, "unexpected `%c'\n", c);
 	}
 	Ref ref = push_node(reader, SERD_LITERAL, "", 0);
-	push_byte(reader, ref, eat_byte_safe(reader, c));
-	while ((c = peek_byte(reader)) && is_alpha(c)) {
-		push_byte(reader, ref, eat_byte_safe(reader, c));
-	}
+	do {
+		read_ascii_run(reader, ref, scan_alpha);
+	} while (is_alpha(peek_byte(reader)));
 	while (peek_byte(reader) == '-') {
 		push_byte(reader, ref, eat_byte_safe(reader, '-'));
 		while ((c = peek_byte(reader)) && (is_alpha(c) || is_digit(c))) {
-			push_byte(reader, ref, eat_byte_safe(reader, c));
+			read_ascii_run(reader, ref, scan_alnum);
 		}
 	}
 	return ref;
@@ -602,26 +1016,75 @@ read_IRIREF_scheme(SerdReader* reader, Ref dest)
 			             "bad IRI scheme char `%X'\n", c);
 		}
 
-		push_byte(reader, dest, eat_byte_safe(reader, c));
 		if (c == ':') {
+			push_byte(reader, dest, eat_byte_safe(reader, c));
 			return true;  // End of scheme
 		}
+
+		read_ascii_run(reader, dest, scan_IRI_scheme);
 	}
 
 	return false;
 }
 
+static bool
+has_IRIREF_scheme(const uint8_t* str, size_t len)
+{
+	if (!len || !isalpha(str[0])) {
+		return false;
+	}
+
+	for (size_t i = 1; i < len; ++i) {
+		if (str[i] == ':') {
+			return true;
+		} else if (!is_uri_scheme_char(str[i])) {
+			return false;
+		}
+	}
+
+	return false;
+}
+
+// Read an IRIREF without escapes as a view, or return zero
+// Initial '<' is already eaten by caller
 static Ref
-read_IRIREF(SerdReader* reader)
+read_IRIREF_view(SerdReader* reader)
 {
-	TRY_RET(eat_byte_check(reader, '<'));
-	Ref ref = push_node(reader, SERD_URI, "", 0);
+	const size_t         limit   = view_limit(reader);
+	const uint8_t* const str     = peek_bytes(reader);
+	size_t               n_ascii = 0;
+	const size_t         n       = serd_scan_utf8(str, limit, true, &n_ascii);
+	if (n == limit || str[n] != '>' ||
+	    (!fancy_syntax(reader) && !has_IRIREF_scheme(str, n))) {
+		return 0;
+	}
+
+	const Ref ref = push_node_view(reader, SERD_URI, str, n, n_ascii);
+	skip_bytes(reader, n + 1);
+	return ref;
+}
+
+// Initial '<' is already eaten by caller
+static Ref
+read_IRIREF_chars(SerdReader* reader)
+{
+	Ref ref = read_IRIREF_view(reader);
+	if (ref) {
+		return ref;
+	}
+
+	ref = push_node(reader, SERD_URI, "", 0);
 	if (!fancy_syntax(reader) && !read_IRIREF_scheme(reader, ref)) {
 		return pop_node(reader, ref);
 	}
 
 	uint32_t code = 0;
 	while (!reader->status) {
+		if (read_plain_run(reader, ref, serd_scan_iri) ||
+		    read_utf8_run(reader, ref, true)) {
+			continue;
+		}
+
 		const uint8_t c = eat_byte_safe(reader, peek_byte(reader));
 		switch (c) {
 		case '"': case '<': case '^': case '`': case '{': case '|': case '}':
@@ -671,6 +1134,63 @@ read_IRIREF(SerdReader* reader)
 	return pop_node(reader, ref);
 }
 
+static Ref
+read_IRIREF(SerdReader* reader)
+{
+	TRY_RET(eat_byte_check(reader, '<'));
+	return check_token(reader, read_IRIREF_chars(reader), '>', false);
+}
+
+// Read a prefixed name without escapes as a view, or return zero
+static Ref
+read_PrefixedName_view(SerdReader* reader)
+{
+	static const unsigned prefix_middle = SERD_CHAR_PN_CHARS | SERD_CHAR_DOT;
+	static const unsigned local_start   = SERD_CHAR_PN_CHARS | SERD_CHAR_COLON;
+	static const unsigned local_middle  = local_start | SERD_CHAR_DOT;
+
+	const size_t         limit   = view_limit(reader);
+	const uint8_t* const str     = peek_bytes(reader);
+	size_t               n_ascii = 0;
+	size_t               n       = scan_name_start(
+		str, limit, SERD_CHAR_ALPHA, SERD_NAME_PN_CHARS_BASE, &n_ascii);
+	if (n) {  // PN_PREFIX
+		// Leave other non-ASCII PN_CHARS to the reader, which is stricter
+		n += scan_name_run(str + n, limit - n, prefix_middle,
+		                   SERD_NAME_PN_CHARS_BASE, &n_ascii);
+		if (n == limit || str[n - 1] == '.') {
+			return 0;
+		}
+	}
+
+	if (n == limit || str[n++] != ':') {
+		return 0;
+	}
+
+	++n_ascii;
+	size_t size = 0;
+	if (n < limit && str[n] != '-' &&
+	    (size = scan_name_start(str + n, limit - n, local_start,
+	                            SERD_NAME_PN_CHARS_BASE, &n_ascii))) {
+		// PN_LOCAL
+		n += size;
+		n += scan_name_run(str + n, limit - n, local_middle,
+		                   SERD_NAME_PN_CHARS, &n_ascii);
+		if (str[n - 1] == '.') {
+			return 0;
+		}
+	}
+
+	if (n == limit ||
+	    (serd_char_classes[str[n]] & (SERD_CHAR_UTF8 | SERD_CHAR_PLX))) {
+		return 0;  // Name continues with a bad character or escape
+	}
+
+	const Ref ref = push_node_view(reader, SERD_CURIE, str, n, n_ascii);
+	skip_bytes(reader, n);
+	return ref;
+}
+
 static bool
 read_PrefixedName(SerdReader* reader, Ref dest, bool read_prefix, bool* ate_dot)
 {
@@ -684,12 +1204,37 @@ read_PrefixedName(SerdReader* reader, Ref dest, bool read_prefix, bool* ate_dot)
 	return read_PN_LOCAL(reader, dest, ate_dot) <= SERD_FAILURE;
 }
 
+/**
+   Check that the prefix of the prefixed name at `ref` is defined.
+
+   This is done by the writer when reading normally, but must be done here
+   while validating, since the name may be a view which is soon stale.
+*/
+static bool
+check_PrefixedName(SerdReader* reader, Ref ref)
+{
+	const SerdNode* const node = deref(reader, ref);
+	SerdChunk             prefix;
+	SerdChunk             suffix;
+	if (!reader->validating || node->type != SERD_CURIE ||
+	    !serd_env_expand(reader->env, node, &prefix, &suffix)) {
+		return true;
+	} else if (reader->undefined_sink) {
+		// The prefix may be defined before this input, so let the caller check
+		return !reader->undefined_sink(reader->handle, node);
+	}
+
+	return r_err(reader, SERD_ERR_BAD_CURIE,
+	             "undefined namespace prefix `%.*s'\n",
+	             (int)node->n_bytes, (const char*)node->buf);
+}
+
 static bool
 read_0_9(SerdReader* reader, Ref str, bool at_least_one)
 {
 	unsigned count = 0;
-	for (uint8_t c; is_digit((c = peek_byte(reader))); ++count) {
-		push_byte(reader, str, eat_byte_safe(reader, c));
+	for (; is_digit(peek_byte(reader)); ++count) {
+		read_ascii_run(reader, str, scan_digits);
 	}
 	if (at_least_one && count == 0) {
 		r_err(reader, SERD_ERR_BAD_SYNTAX, "expected digit\n");
@@ -769,8 +1314,18 @@ read_iri(SerdReader* reader, Ref* dest, bool* ate_dot)
 		*dest = read_IRIREF(reader);
 		return true;
 	default:
-		*dest = push_node(reader, SERD_CURIE, "", 0);
-		return read_PrefixedName(reader, *dest, true, ate_dot);
+		if (!(*dest = read_PrefixedName_view(reader))) {
+			*dest = push_node(reader, SERD_CURIE, "", 0);
+			if (!read_PrefixedName(reader, *dest, true, ate_dot)) {
+				return false;
+			}
+		}
+
+		if (!check_PrefixedName(reader, *dest)) {
+			*dest = pop_node(reader, *dest);
+			return false;
+		}
+		return true;
 	}
 }
 
@@ -810,6 +1365,13 @@ read_verb(SerdReader* reader, Ref* dest)
 		return (*dest = read_IRIREF(reader));
 	}
 
+	if ((*dest = read_PrefixedName_view(reader))) {
+		if (!check_PrefixedName(reader, *dest)) {
+			return (*dest = pop_node(reader, *dest));
+		}
+		return true;
+	}
+
 	/* Either a qname, or "a".  Read the prefix first, and if it is in fact
 	   "a", produce that instead.
 	*/
@@ -829,15 +1391,51 @@ read_verb(SerdReader* reader, Ref* dest)
 		return r_err(reader, SERD_ERR_BAD_SYNTAX, "bad verb\n");
 	}
 
+	if (!check_PrefixedName(reader, *dest)) {
+		return (*dest = pop_node(reader, *dest));
+	}
+
 	return true;
 }
 
+// Read an ASCII blank node label as a view, or return zero
+// Initial "_:" is already eaten by caller
+static Ref
+read_BLANK_NODE_LABEL_view(SerdReader* reader)
+{
+	const size_t         limit   = view_limit(reader);
+	const uint8_t* const str     = peek_bytes(reader);
+	size_t               n_ascii = 0;
+	if (reader->bprefix) {
+		return 0;  // Label is not contiguous in input
+	}
+
+	const size_t n = scan_name_run(str, limit, SERD_CHAR_PN_CHARS | SERD_CHAR_DOT,
+	                               SERD_NAME_PN_CHARS, &n_ascii);
+	if (n == 0 || n == limit || (str[n] & 0x80) ||
+	    str[0] == '.' || str[n - 1] == '.') {
+		return 0;
+	} else if (fancy_syntax(reader) && n > 1 && is_digit(str[1]) &&
+	           (str[0] == 'b' || str[0] == 'B')) {
+		return 0;  // May clash with generated IDs
+	}
+
+	const Ref ref = push_node_view(reader, SERD_BLANK, str, n, n_ascii);
+	skip_bytes(reader, n);
+	return ref;
+}
+
 static Ref
 read_BLANK_NODE_LABEL(SerdReader* reader, bool* ate_dot)
 {
 	eat_byte_safe(reader, '_');
 	eat_byte_check(reader, ':');
-	Ref ref = push_node(reader, SERD_BLANK,
+	Ref ref = read_BLANK_NODE_LABEL_view(reader);
+	if (ref) {
+		return ref;
+	}
+
+	ref = push_node(reader, SERD_BLANK,
 	                    reader->bprefix ? (char*)reader->bprefix : "",
 	                    reader->bprefix_len);
 
@@ -849,9 +1447,9 @@ read_BLANK_NODE_LABEL(SerdReader* reader, bool* ate_dot)
 		return pop_node(reader, ref);
 	}
 
-	while ((c = peek_byte(reader))) {  // Middle: (PN_CHARS | '.')*
-		if (c == '.') {
-			push_byte(reader, ref, eat_byte_safe(reader, c));
+	while (peek_byte(reader)) {  // Middle: (PN_CHARS | '.')*
+		if (read_name_run(reader, ref, SERD_CHAR_PN_CHARS | SERD_CHAR_DOT)) {
+			continue;
 		} else if (read_PN_CHARS(reader, ref)) {
 			break;
 		}
@@ -875,6 +1473,8 @@ read_BLANK_NODE_LABEL(SerdReader* reader, bool* ate_dot)
 				r_err(reader, SERD_ERR_ID_CLASH,
 				      "found both `b' and `B' blank IDs, prefix required\n");
 				return pop_node(reader, ref);
+			} else if (n->buf[reader->bprefix_len] == 'B') {
+				reader->seen_Bgenid = true;
 			}
 		}
 	}
@@ -902,6 +1502,7 @@ read_anon(SerdReader* reader, ReadContext ctx, bool subject, Ref* dest)
 	const SerdStatementFlags old_flags = *ctx.flags;
 	bool empty;
 	eat_byte_safe(reader, '[');
+	++reader->skip.depth;
 	if ((empty = peek_delim(reader, ']'))) {
 		*ctx.flags |= (subject) ? SERD_EMPTY_S : SERD_EMPTY_O;
 	} else {
@@ -934,11 +1535,13 @@ read_anon(SerdReader* reader, ReadContext ctx, bool subject, Ref* dest)
 		}
 		read_ws_star(reader);
 		if (reader->end_sink) {
-			reader->end_sink(reader->handle, deref(reader, *dest));
+			TRY_RET(!serd_reader_emit_end(reader, deref(reader, *dest)));
 		}
 		*ctx.flags = old_flags;
 	}
-	return (eat_byte_check(reader, ']') == ']');
+	TRY_RET(eat_byte_check(reader, ']'));
+	--reader->skip.depth;
+	return true;
 }
 
 /* If emit is true: recurses, calling statement_sink for every statement
@@ -995,6 +1598,11 @@ read_object(SerdReader* reader, ReadContext* ctx, bool emit, bool* ate_dot)
 		TRY_THROW(ret = read_literal(reader, &o, &datatype, &lang, &flags, ate_dot));
 		break;
 	default:
+		if ((o = read_PrefixedName_view(reader))) {
+			TRY_THROW(ret = check_PrefixedName(reader, o));
+			break;
+		}
+
 		/* Either a boolean literal, or a qname.  Read the prefix first, and if
 		   it is in fact a "true" or "false" literal, produce that instead.
 		*/
@@ -1009,10 +1617,10 @@ read_object(SerdReader* reader, ReadContext* ctx, bool emit, bool* ate_dot)
 			ret = true;
 		} else if (read_PN_PREFIX_tail(reader, o) > SERD_FAILURE) {
 			ret = false;
+		} else if (!(ret = read_PrefixedName(reader, o, false, ate_dot))) {
+			r_err(reader, SERD_ERR_BAD_SYNTAX, "expected prefixed name\n");
 		} else {
-			if (!(ret = read_PrefixedName(reader, o, false, ate_dot))) {
-				r_err(reader, SERD_ERR_BAD_SYNTAX, "expected prefixed name\n");
-			}
+			TRY_THROW(ret = check_PrefixedName(reader, o));
 		}
 	}
 
@@ -1095,13 +1703,17 @@ end_collection(SerdReader* reader, ReadContext ctx, Ref n1, Ref n2, bool ret)
 	pop_node(reader, n2);
 	pop_node(reader, n1);
 	*ctx.flags &= ~SERD_LIST_CONT;
-	return ret && (eat_byte_safe(reader, ')') == ')');
+	TRY_RET(ret);
+	eat_byte_safe(reader, ')');
+	--reader->skip.depth;
+	return true;
 }
 
 static bool
 read_collection(SerdReader* reader, ReadContext ctx, Ref* dest)
 {
 	eat_byte_safe(reader, '(');
+	++reader->skip.depth;
 	bool end = peek_delim(reader, ')');
 	*dest = end ? reader->rdf_nil : blank_id(reader);
 	if (ctx.subject) {
@@ -1139,7 +1751,7 @@ read_collection(SerdReader* reader, ReadContext ctx, Ref* dest)
 			if (!rest) {
 				rest = n2 = blank_id(reader);  // First pass, push
 			} else {
-				set_blank_id(reader, rest, genid_size(reader));
+				set_blank_id(reader, rest);
 			}
 		}
 
@@ -1185,13 +1797,18 @@ read_labelOrSubject(SerdReader* reader)
 	switch (peek_byte(reader)) {
 	case '[':
 		eat_byte_safe(reader, '[');
+		++reader->skip.depth;
 		read_ws_star(reader);
 		TRY_RET(eat_byte_check(reader, ']'));
+		--reader->skip.depth;
 		return blank_id(reader);
 	case '_':
 		return read_BLANK_NODE_LABEL(reader, &ate_dot);
 	default:
-		read_iri(reader, &subject, &ate_dot);
+		if (!read_iri(reader, &subject, &ate_dot)) {
+			pop_node(reader, subject);
+			return r_err(reader, SERD_ERR_BAD_SYNTAX, "invalid graph name\n");
+		}
 	}
 	return subject;
 }
@@ -1225,10 +1842,9 @@ read_base(SerdReader* reader, bool sparql, bool token)
 	Ref uri;
 	read_ws_star(reader);
 	TRY_RET(uri = read_IRIREF(reader));
-	if (reader->base_sink) {
-		reader->base_sink(reader->handle, deref(reader, uri));
-	}
+	const SerdStatus st = serd_reader_emit_base(reader, deref(reader, uri));
 	pop_node(reader, uri);
+	TRY_RET(!st);
 
 	read_ws_star(reader);
 	if (!sparql) {
@@ -1265,11 +1881,8 @@ read_prefixID(SerdReader* reader, bool sparql, bool token)
 		return false;
 	}
 
-	if (reader->prefix_sink) {
-		ret = !reader->prefix_sink(reader->handle,
-		                           deref(reader, name),
-		                           deref(reader, uri));
-	}
+	ret = !serd_reader_emit_prefix(
+		reader, deref(reader, name), deref(reader, uri));
 	pop_node(reader, uri);
 	pop_node(reader, name);
 	if (!sparql) {
@@ -1306,6 +1919,7 @@ static bool
 read_wrappedGraph(SerdReader* reader, ReadContext* ctx)
 {
 	TRY_RET(eat_byte_check(reader, '{'));
+	++reader->skip.depth;
 	read_ws_star(reader);
 	while (peek_byte(reader) != '}') {
 		bool ate_dot = false;
@@ -1327,14 +1941,18 @@ read_wrappedGraph(SerdReader* reader, ReadContext* ctx)
 		}
 		read_ws_star(reader);
 	}
-	return eat_byte_check(reader, '}');
+	TRY_RET(eat_byte_check(reader, '}'));
+	--reader->skip.depth;
+	return true;
 }
 
 static int
 tokcmp(SerdReader* reader, Ref ref, const char* tok, size_t n)
 {
+	// Keywords are never read as views, which may point into a stale page
 	SerdNode* node = deref(reader, ref);
-	if (!node || node->n_bytes != n) {
+	if (!node || node->n_bytes != n ||
+	    (reader->stack.buf[ref - 1] & SERD_STACK_TAG)) {
 		return -1;
 	}
 	return serd_strncasecmp((const char*)node->buf, tok, n);
@@ -1399,6 +2017,7 @@ read_n3_statement(SerdReader* reader)
 			ret = r_err(reader, SERD_ERR_BAD_SYNTAX, "bad subject\n");
 		} else if (!read_triples(reader, ctx, &ate_dot)) {
 			if (!(ret = (s_type == '[')) && ate_dot) {
+				reader->error_ended = true;
 				ret = r_err(reader, SERD_ERR_BAD_SYNTAX,
 				            "unexpected end of statement\n");
 			}
@@ -1412,79 +2031,496 @@ read_n3_statement(SerdReader* reader)
 	return ret;
 }
 
+/**
+   Skip the rest of a statement with an error.
+
+   Without parsing, the end of a Turtle or TriG statement is taken to be the
+   end of the next line which ends with a '.' or '}' outside any IRI, string,
+   comment, or brackets, like where documents are split for reading in
+   parallel, so a statement over several lines is skipped entirely rather
+   than causing an error on every line.  A line which ends in a short string
+   or IRI is also the end, since those can not continue on the next line.
+   Other statements, and those which already ended at the error, are skipped
+   to the end of the line.
+   If the input ends first, skipping continues at the start of the next
+   input, which happens with fed input.
+*/
 static void
-skip_until(SerdReader* reader, uint8_t byte)
+skip_statement(SerdReader* reader)
 {
-	for (uint8_t c = 0; (c = peek_byte(reader)) && c != byte;) {
-		eat_byte_safe(reader, c);
+	SkipState* const skip   = &reader->skip;
+	const bool       to_eol = (reader->syntax == SERD_NTRIPLES ||
+	                           reader->syntax == SERD_NQUADS ||
+	                           reader->error_ended);
+
+	reader->skipping = true;
+	while (serd_byte_source_skip_to(
+		       &reader->source, '\n', to_eol ? NULL : skip) == '\n') {
+		const bool in_token = skip->close && skip->close != '\n';
+		const bool broken   = (in_token && !skip->long_string &&
+		                       skip->n_quotes != 2);  // Not an empty string
+		const bool at_end   = (!in_token && !skip->depth &&
+		                       (skip->last == '.' || skip->last == '}'));
+		if (to_eol || broken || at_end) {
+			memset(skip, '\0', sizeof(SkipState));
+			reader->skipping    = false;
+			reader->error_ended = false;
+			return;
+		}
+
+		// Only long strings continue on the next line
+		eat_byte_safe(reader, '\n');
+		skip->close    = skip->long_string ? skip->close : 0;
+		skip->n_quotes = 0;
+		skip->last     = 0;
+		skip->escaped  = false;
+	}
+
+	reader->source.eof = true;
+}
+
+/// Recover from a statement with an error in lax mode, or return false
+static bool
+recover(SerdReader* reader, size_t stack_size)
+{
+	if (reader->strict) {
+		return false;
 	}
+
+	pop_to(reader, stack_size);
+	skip_statement(reader);
+
+	reader->status = SERD_SUCCESS;
+	return true;
 }
 
 bool
 read_turtleTrigDoc(SerdReader* reader)
 {
 	while (!reader->source.eof) {
-		if (!read_n3_statement(reader)) {
-			if (reader->strict) {
-				return 0;
-			}
-			skip_until(reader, '\n');
-			reader->status = SERD_SUCCESS;
+		const size_t stack_size = reader->stack.size;
+		if (reader->skipping) {
+			skip_statement(reader);  // Continue skipping from the last input
+		} else if (read_n3_statement(reader)) {
+			serd_reader_checkpoint(reader);
+		} else if (!recover(reader, stack_size)) {
+			return 0;
 		}
+		trim_stack(reader);
 	}
 	return reader->status <= SERD_FAILURE;
 }
 
-bool
-read_nquadsDoc(SerdReader* reader)
+/* Fast reading of simple NTriples and NQuads lines */
+
+/// Bits of character classes in nq_classes
+enum {
+	NQ_WS    = 1U << 0U,  ///< Space or tab
+	NQ_IRI   = 1U << 1U,  ///< Plain IRI character
+	NQ_STR   = 1U << 2U,  ///< Plain string character
+	NQ_LABEL = 1U << 3U,  ///< Blank node label character or '.'
+	NQ_ALPHA = 1U << 4U,  ///< Letter
+	NQ_DIGIT = 1U << 5U   ///< Digit
+};
+
+#define N 0U
+#define I NQ_IRI
+#define S NQ_STR
+#define W (NQ_WS | NQ_STR)
+#define P (NQ_IRI | NQ_STR)
+#define L (NQ_IRI | NQ_STR | NQ_LABEL)
+#define A (NQ_IRI | NQ_STR | NQ_LABEL | NQ_ALPHA)
+#define D (NQ_IRI | NQ_STR | NQ_LABEL | NQ_DIGIT)
+
+/// Classes of ASCII characters, non-ASCII bytes have none
+static const uint8_t nq_classes[256] = {
+	N, S, S, S, S, S, S, S, S, W, N, S, S, N, S, S,
+	S, S, S, S, S, S, S, S, S, S, S, S, S, S, S, S,
+	W, P, N, P, P, P, P, I, P, P, P, P, P, L, L, P,
+	D, D, D, D, D, D, D, D, D, D, P, P, S, P, S, P,
+	P, A, A, A, A, A, A, A, A, A, A, A, A, A, A, A,
+	A, A, A, A, A, A, A, A, A, A, A, P, N, P, S, L,
+	S, A, A, A, A, A, A, A, A, A, A, A, A, A, A, A,
+	A, A, A, A, A, A, A, A, A, A, A, S, S, S, P, P,
+};
+
+#undef D
+#undef A
+#undef L
+#undef P
+#undef W
+#undef S
+#undef I
+#undef N
+
+/// A term in a line, which is pushed as a node once the line is read
+typedef struct {
+	size_t   offset;   ///< Offset of the string in the line
+	size_t   n_bytes;  ///< Length of the string in bytes
+	size_t   n_chars;  ///< Number of characters, counted as when copying
+	SerdType type;     ///< Node type, or SERD_NOTHING if there is no term
+} NQTerm;
+
+/// Return the index after the run of characters in `mask` at `i`
+static inline size_t
+nq_span(const uint8_t* s, size_t end, size_t i, uint8_t mask)
 {
-	while (!reader->source.eof) {
-		SerdStatementFlags flags   = 0;
-		ReadContext        ctx     = { 0, 0, 0, 0, 0, 0, &flags };
-		bool               ate_dot = false;
-		char               s_type  = false;
-		read_ws_star(reader);
-		if (peek_byte(reader) == '\0') {
-			reader->source.eof = true;
+	while (i < end && (nq_classes[s[i]] & mask)) {
+		++i;
+	}
+	return i;
+}
+
+/// Skip a multi-byte UTF-8 character at `*i`, or return false
+static inline bool
+nq_skip_utf8(const uint8_t* s, size_t end, size_t* i)
+{
+	const uint32_t size = utf8_num_bytes(s[*i]);
+	if (size <= 1 || size > 4 || *i + size > end) {
+		return false;
+	}
+
+	for (uint32_t k = 1; k < size; ++k) {
+		if (!(s[*i + k] & 0x80)) {
+			return false;
+		}
+	}
+
+	*i += size;
+	return true;
+}
+
+/// Scan an IRIREF with a scheme and no escapes at `*i`, or return false
+static bool
+nq_scan_IRIREF(const uint8_t* s, size_t end, size_t* i, NQTerm* term)
+{
+	const size_t start   = *i + 1;
+	size_t       j       = start;
+	size_t       n_chars = 0;
+	while (j < end) {
+		const size_t n = serd_scan_iri(s + j, end - j);
+		j += n;
+		n_chars += n;
+		if (j == end || !(s[j] & 0x80)) {
+			break;
+		}
+
+		const size_t u = serd_scan_utf8(s + j, end - j, true, &n_chars);
+		if (!u && !nq_skip_utf8(s, end, &j)) {
 			break;
-		} else if (peek_byte(reader) == '@') {
-			return r_err(reader, SERD_ERR_BAD_SYNTAX,
-			             "syntax does not support directives\n");
 		}
+		j += u;
+	}
 
-		// subject predicate object
-		if (!(ctx.subject = read_subject(reader, ctx, &ctx.subject, &s_type)) ||
-		    !read_ws_star(reader) ||
-		    !(ctx.predicate = read_IRIREF(reader)) ||
-		    !read_ws_star(reader) ||
-		    !read_object(reader, &ctx, false, &ate_dot)) {
+	if (j == end || s[j] != '>' || !has_IRIREF_scheme(s + start, j - start)) {
+		return false;
+	}
+
+	term->offset  = start;
+	term->n_bytes = j - start;
+	term->n_chars = n_chars;
+	term->type    = SERD_URI;
+	*i            = j + 1;
+	return true;
+}
+
+/// Scan a blank node label without a trailing '.' at `*i`, or return false
+static bool
+nq_scan_BLANK_NODE_LABEL(const uint8_t* s, size_t end, size_t* i, NQTerm* term)
+{
+	const size_t start = *i + 2;
+	if (start >= end || s[*i + 1] != ':') {
+		return false;
+	}
+
+	const size_t j = nq_span(s, end, start, NQ_LABEL);
+	if (j == start || j == end || (s[j] & 0x80) ||
+	    s[start] == '.' || s[j - 1] == '.') {
+		return false;
+	}
+
+	term->offset  = start;
+	term->n_bytes = term->n_chars = j - start;
+	term->type    = SERD_BLANK;
+	*i            = j;
+	return true;
+}
+
+/// Scan a short string without escapes at `*i`, or return false
+static bool
+nq_scan_STRING_LITERAL_QUOTE(const uint8_t* s,
+                             size_t         end,
+                             size_t*        i,
+                             NQTerm*        term,
+                             SerdNodeFlags* flags)
+{
+	const size_t start   = *i + 1;
+	size_t       j       = start;
+	size_t       n_chars = 0;
+	if (start + 1 < end && s[start] == '"' && s[start + 1] == '"') {
+		return false;  // Long string
+	}
+
+	while (j < end) {
+		const size_t n = serd_scan_string(s + j, end - j);
+		j += n;
+		n_chars += n;
+		if (j == end || s[j] == '"') {
+			break;
+		} else if (s[j] == '\'') {
+			*flags |= SERD_HAS_QUOTE;
+			++j;
+			++n_chars;
+			continue;
+		} else if (!(s[j] & 0x80)) {
 			return false;
 		}
 
-		if (!ate_dot) {  // graphLabel?
-			TRY_RET(read_ws_star(reader));
-			switch (peek_byte(reader)) {
-			case '.':
-				break;
-			case '_':
-				ctx.graph = read_BLANK_NODE_LABEL(reader, &ate_dot);
-				break;
-			default:
-				if (!(ctx.graph = read_IRIREF(reader))) {
-					return false;
-				}
-			}
+		const size_t u = serd_scan_utf8(s + j, end - j, false, &n_chars);
+		if (!u && !nq_skip_utf8(s, end, &j)) {
+			return false;
+		}
+		j += u;
+	}
+
+	if (j == end) {
+		return false;
+	}
+
+	term->offset  = start;
+	term->n_bytes = j - start;
+	term->n_chars = n_chars;
+	term->type    = SERD_LITERAL;
+	*i            = j + 1;
+	return true;
+}
 
-			// Terminating '.'
-			TRY_RET(read_ws_star(reader));
-			eat_byte_check(reader, '.');
+/// Scan a language tag after '@' at `*i`, or return false
+static bool
+nq_scan_LANGTAG(const uint8_t* s, size_t end, size_t* i, NQTerm* term)
+{
+	const size_t start = *i + 1;
+	size_t       j     = nq_span(s, end, start, NQ_ALPHA);
+	if (j == start) {
+		return false;
+	}
+
+	while (j < end && s[j] == '-') {
+		j = nq_span(s, end, j + 1, NQ_ALPHA | NQ_DIGIT);
+	}
+
+	term->offset  = start;
+	term->n_bytes = term->n_chars = j - start;
+	term->type    = SERD_LITERAL;
+	*i            = j;
+	return true;
+}
+
+/// Scan a literal with an optional language or datatype, or return false
+static bool
+nq_scan_literal(const uint8_t* s,
+                size_t         end,
+                size_t*        i,
+                NQTerm*        term,
+                NQTerm*        meta,
+                SerdNodeFlags* flags)
+{
+	if (!nq_scan_STRING_LITERAL_QUOTE(s, end, i, term, flags)) {
+		return false;
+	} else if (*i < end && s[*i] == '@') {
+		return nq_scan_LANGTAG(s, end, i, meta);
+	} else if (*i + 2 < end && s[*i] == '^') {
+		if (s[*i + 1] != '^' || s[*i + 2] != '<') {
+			return false;
 		}
 
-		TRY_RET(emit_statement(reader, ctx, ctx.object, ctx.datatype, ctx.lang));
-		pop_node(reader, ctx.graph);
-		pop_node(reader, ctx.lang);
-		pop_node(reader, ctx.datatype);
-		pop_node(reader, ctx.object);
+		*i += 2;
+		return nq_scan_IRIREF(s, end, i, meta);
+	}
+
+	return true;
+}
+
+/// Scan an IRI or blank node at `*i`, or return false
+static bool
+nq_scan_resource(const uint8_t* s, size_t end, size_t* i, NQTerm* term)
+{
+	switch (s[*i]) {
+	case '<': return nq_scan_IRIREF(s, end, i, term);
+	case '_': return nq_scan_BLANK_NODE_LABEL(s, end, i, term);
+	default:  return false;
+	}
+}
+
+/// Push a term as a node, which is a view into the line if possible
+static Ref
+nq_push(SerdReader* reader, const uint8_t* s, size_t limit, const NQTerm* term)
+{
+	const bool prefixed = term->type == SERD_BLANK && reader->bprefix;
+	if (term->type == SERD_NOTHING) {
+		return 0;
+	} else if (!prefixed && term->offset + term->n_bytes < limit) {
+		return push_node_view(reader, term->type, s + term->offset,
+		                      term->n_bytes, term->n_chars);
+	}
+
+	const Ref ref = push_node(reader, term->type,
+	                          prefixed ? (const char*)reader->bprefix : "",
+	                          prefixed ? reader->bprefix_len : 0);
+	if (term->n_bytes) {
+		memcpy(push_reserve(reader, ref, term->n_bytes, term->n_chars),
+		       s + term->offset, term->n_bytes);
+	}
+	return ref;
+}
+
+/**
+   Read a simple NTriples or NQuads statement on one line in memory.
+
+   This is a fast path for the common case, which reads terms without escapes
+   in one pass over the line.  If the line is not simple, or not entirely in
+   memory, nothing is read and SERD_FAILURE is returned, so the statement must
+   be read by the general parser, which reports any errors.  Otherwise, the
+   statement is read and passed on, and an error is returned if a sink failed.
+*/
+static SerdStatus
+read_nquads_line(SerdReader* reader)
+{
+	NQTerm subject   = { 0, 0, 0, SERD_NOTHING };
+	NQTerm predicate = { 0, 0, 0, SERD_NOTHING };
+	NQTerm object    = { 0, 0, 0, SERD_NOTHING };
+	NQTerm meta      = { 0, 0, 0, SERD_NOTHING };  // Datatype or language
+	NQTerm graph     = { 0, 0, 0, SERD_NOTHING };
+
+	const uint8_t* const s         = peek_bytes(reader);
+	const size_t         end       = serd_byte_source_available(&reader->source);
+	size_t               i         = serd_scan_ws(s, end);
+	SerdNodeFlags        lit_flags = 0;
+	if (reader->status || i == end ||
+	    !nq_scan_resource(s, end, &i, &subject) ||
+	    (i = nq_span(s, end, i, NQ_WS)) == end || s[i] != '<' ||
+	    !nq_scan_IRIREF(s, end, &i, &predicate) ||
+	    (i = nq_span(s, end, i, NQ_WS)) == end ||
+	    !(s[i] == '"'
+	      ? nq_scan_literal(s, end, &i, &object, &meta, &lit_flags)
+	      : nq_scan_resource(s, end, &i, &object)) ||
+	    (i = nq_span(s, end, i, NQ_WS)) == end) {
+		return SERD_FAILURE;
+	}
+
+	if (reader->syntax == SERD_NQUADS && s[i] != '.') {
+		if (!nq_scan_resource(s, end, &i, &graph) ||
+		    (i = nq_span(s, end, i, NQ_WS)) == end) {
+			return SERD_FAILURE;
+		}
+	}
+
+	if (s[i] != '.') {
+		return SERD_FAILURE;
+	}
+
+	// Push nodes in the order they would be read, then skip the statement
+	const size_t       stack_size = reader->stack.size;
+	const size_t       limit      = view_limit(reader);
+	SerdStatementFlags flags      = 0;
+	ReadContext        ctx        = { 0, 0, 0, 0, 0, 0, &flags };
+
+	ctx.subject   = nq_push(reader, s, limit, &subject);
+	ctx.predicate = nq_push(reader, s, limit, &predicate);
+	ctx.object    = nq_push(reader, s, limit, &object);
+	if (meta.type == SERD_URI) {
+		ctx.datatype = nq_push(reader, s, limit, &meta);
+	} else {
+		ctx.lang = nq_push(reader, s, limit, &meta);
+	}
+	ctx.graph = nq_push(reader, s, limit, &graph);
+
+	deref(reader, ctx.object)->flags = lit_flags;
+	skip_bytes(reader, i + 1);
+
+	const bool ok = emit_statement(
+		reader, ctx, ctx.object, ctx.datatype, ctx.lang);
+	pop_to(reader, stack_size);
+	return ok ? SERD_SUCCESS : SERD_ERR_UNKNOWN;
+}
+
+static bool
+read_nquads_statement(SerdReader* reader)
+{
+	SerdStatementFlags flags   = 0;
+	ReadContext        ctx     = { 0, 0, 0, 0, 0, 0, &flags };
+	bool               ate_dot = false;
+	char               s_type  = false;
+	read_ws_star(reader);
+	if (peek_byte(reader) == '\0') {
+		reader->source.eof = true;
+		return true;
+	} else if (peek_byte(reader) == '@') {
+		return r_err(reader, SERD_ERR_BAD_SYNTAX,
+		             "syntax does not support directives\n");
+	}
+
+	// subject predicate object
+	if (!(ctx.subject = read_subject(reader, ctx, &ctx.subject, &s_type)) ||
+	    !read_ws_star(reader) ||
+	    !(ctx.predicate = read_IRIREF(reader)) ||
+	    !read_ws_star(reader) ||
+	    !read_object(reader, &ctx, false, &ate_dot)) {
+		return false;
+	}
+
+	if (!ate_dot) {  // graphLabel?
+		TRY_RET(read_ws_star(reader));
+		switch (peek_byte(reader)) {
+		case '.':
+			break;
+		case '_':
+			ctx.graph = read_BLANK_NODE_LABEL(reader, &ate_dot);
+			break;
+		default:
+			if (!(ctx.graph = read_IRIREF(reader))) {
+				return false;
+			}
+		}
+
+		// Terminating '.'
+		TRY_RET(read_ws_star(reader));
+		eat_byte_check(reader, '.');
+	}
+
+	return emit_statement(reader, ctx, ctx.object, ctx.datatype, ctx.lang);
+}
+
+bool
+read_line_statement(SerdReader* reader)
+{
+	const size_t     stack_size = reader->stack.size;
+	const SerdStatus st         = read_nquads_line(reader);
+	if (st != SERD_FAILURE) {
+		return !st;
+	} else if (reader->syntax == SERD_NQUADS ? read_nquads_statement(reader)
+	                                         : read_n3_statement(reader)) {
+		pop_to(reader, stack_size);
+		return true;
+	}
+
+	return false;
+}
+
+bool
+read_nquadsDoc(SerdReader* reader)
+{
+	while (!reader->source.eof) {
+		const size_t stack_size = reader->stack.size;
+		if (reader->skipping) {
+			skip_statement(reader);  // Continue skipping from the last input
+		} else if (read_line_statement(reader)) {
+			serd_reader_checkpoint(reader);
+		} else if (reader->syntax == SERD_NQUADS ||
+		           !recover(reader, stack_size)) {
+			return false;  // Errors stop reading NQuads, even when lax
+		}
+		trim_stack(reader);
 	}
 	return reader->status <= SERD_FAILURE;
 }
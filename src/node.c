@@ -68,7 +68,8 @@ serd_node_copy(const SerdNode* node)
 
 	SerdNode copy = *node;
 	uint8_t* buf  = (uint8_t*)malloc(copy.n_bytes + 1);
-	memcpy(buf, node->buf, copy.n_bytes + 1);
+	memcpy(buf, node->buf, copy.n_bytes);
+	buf[copy.n_bytes] = '\0';  // A node view is not terminated
 	copy.buf = buf;
 	return copy;
 }
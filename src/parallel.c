@@ -0,0 +1,1133 @@
+/*
+  Copyright 2019 David Robillard <http://drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "serd_internal.h"
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_PTHREAD
+#    include <pthread.h>
+#endif
+
+/*
+  The input is split into chunks which start at probable statement boundaries:
+  the start of any line for the line-based syntaxes, or of a line after one
+  which ends with a '.' otherwise.  Each chunk is read by a worker thread with
+  its own reader, which records events rather than passing them on.  The
+  calling thread then passes the recorded events to the sinks of the user's
+  reader in order.
+
+  Reading a chunk which starts at a statement boundary gives the same results
+  as reading it as part of the whole document, unless reading depended on what
+  follows the chunk (a statement which spans the boundary, or a guessed
+  boundary inside a long string or TriG graph).  In that case, an error is
+  reported at the end of the chunk, so the chunk is read again together with
+  the next one.  Since the first chunk starts at the start of the document,
+  every chunk that is passed on starts at a statement boundary.
+
+  The reader carries little state between statements.  Directives are only
+  passed to the sinks, so they are recorded and passed on in order like
+  statements.  Generated blank node IDs start from 1 in every chunk and are
+  renumbered when passed on, except in the line-based syntaxes where labels in
+  the input are not renamed to avoid clashes.  There, chunks which generate IDs
+  are read again with the correct next ID, which is rare since only anonymous
+  subjects generate IDs.
+
+  A sink which returns an error may change how the rest of the document is
+  read, so in that case the rest is read by the calling thread, starting at the
+  same chunk and skipping the events which were already passed on.
+
+  With thread handles, the calling thread still decides when a chunk is read
+  correctly and passes its other events on, but leaves its statements pending
+  for any worker to pass to the statement sink with its own handle.  A slot
+  with pending statements is not reused until they have been passed on.
+*/
+
+#define SERD_CHUNK_SIZE_MIN (1U << 16U)  ///< Minimum size of a chunk in bytes
+#define SERD_CHUNK_SIZE_MAX (1U << 22U)  ///< Maximum size of a chunk in bytes
+
+#ifdef HAVE_PTHREAD
+
+typedef enum {
+	EVENT_ERROR,     ///< Error with message and its length in nodes
+	EVENT_BASE,      ///< Base URI in nodes[0]
+	EVENT_PREFIX,    ///< Prefix name and URI in nodes[0] and nodes[1]
+	EVENT_STATEMENT, ///< Statement with nodes in order of statement sink
+	EVENT_END,       ///< End of anonymous node in nodes[0]
+	EVENT_UNDEFINED  ///< Name with a prefix not defined in the chunk in nodes[0]
+} EventType;
+
+/// A sink call or error recorded while reading a chunk
+typedef struct {
+	EventType          type;      ///< Type of event
+	SerdStatementFlags flags;     ///< Statement flags
+	SerdStatus         status;    ///< Error status
+	unsigned           line;      ///< Line of error relative to chunk
+	unsigned           col;       ///< Column of error
+	size_t             nodes[6];  ///< Offsets of nodes, or error message
+} Event;
+
+/// A part of the input and the results of reading it
+typedef struct {
+	SerdStack   arena;        ///< Recorded nodes and error messages
+	Event*      events;       ///< Recorded sink calls and errors
+	size_t      n_events;     ///< Number of recorded events
+	size_t      max_events;   ///< Allocated size of events
+	SerdReader* reader;       ///< Reader which is reading this chunk
+	size_t      begin;        ///< Offset of the start of the chunk in input
+	size_t      end;          ///< Offset of the end of the chunk in input
+	unsigned    first_id;     ///< First blank node ID generated
+	unsigned    n_ids;        ///< Number of blank node IDs generated
+	uint64_t    n_bytes;      ///< Number of bytes read
+	uint64_t    n_nodes;      ///< Number of nodes pushed
+	uint64_t    n_statements; ///< Number of statements read, if validating
+	SerdStatus  status;       ///< Status of reading the chunk
+	bool        dirty;        ///< True iff reading depended on the next chunk
+	bool        seen_genid;   ///< True iff a `b' ID was read
+	bool        seen_Bgenid;  ///< True iff a `B' ID was read without error
+	bool        done;         ///< True iff the chunk has been read
+	unsigned    id_offset;    ///< Offset added to generated IDs to pass on
+	bool        pending;      ///< True iff statements wait for a thread sink
+	bool        claimed;      ///< True iff a worker is passing statements on
+} Chunk;
+
+typedef struct {
+	SerdReader*     reader;      ///< Reader with the user's sinks and settings
+	const uint8_t*  name;        ///< Input name for error reporting
+	const uint8_t*  input;       ///< Entire input in memory
+	size_t          size;        ///< Size of input in bytes
+	size_t          chunk_size;  ///< Approximate size of a chunk in bytes
+	size_t          n_chunks;    ///< Number of chunks in input
+	bool            line_based;  ///< True iff syntax is NTriples or NQuads
+	char*           ids;         ///< Buffer for renumbered blank node IDs
+	Chunk*          chunks;      ///< Ring of chunks being read or emitted
+	size_t          n_slots;     ///< Number of chunks in ring
+	size_t          next_read;   ///< Index of the next chunk to read
+	size_t          next_emit;   ///< Index of the next chunk to emit
+	size_t          line_offset; ///< Input offset of line_count
+	unsigned        line_count;  ///< Number of lines before line_offset
+	size_t          stack_peak;  ///< Largest stack used by a chunk reader
+	bool            per_thread;  ///< True iff statements go to thread sinks
+	size_t          n_pending;   ///< Number of chunks with pending statements
+	SerdStatus      sink_status; ///< First error returned by a thread sink
+	bool            stop;        ///< True iff workers should stop
+	pthread_mutex_t mutex;       ///< Lock for the fields above
+	pthread_cond_t  cond;        ///< Signalled when a chunk is read or freed
+} Parallel;
+
+/// A worker thread which reads chunks
+typedef struct {
+	Parallel* par;     ///< Shared state
+	void*     handle;  ///< Handle for the statement sink, with thread handles
+} Worker;
+
+/// Sinks which pass events to the user's reader after skipping some
+typedef struct {
+	SerdReader* reader;     ///< Reader with the user's sinks
+	bool        per_thread; ///< True iff statements are passed with `handle`
+	void*       handle;     ///< Handle for the statement sink
+	size_t      n_skip;     ///< Number of events which were already passed on
+	SerdStatus  status;     ///< Status returned by the user for the next event
+} Replay;
+
+static size_t
+record_node(Chunk* chunk, const SerdNode* node)
+{
+	if (!node) {
+		return 0;
+	}
+
+	// Keep nodes aligned in the arena by padding the string
+	const size_t align = sizeof(SerdNode);
+	const size_t size  = sizeof(SerdNode) + node->n_bytes + 1;
+	const size_t off   = chunk->arena.size;
+	uint8_t*     mem   = serd_stack_push(&chunk->arena,
+	                                     (size + align - 1) / align * align);
+
+	SerdNode* const copy = (SerdNode*)mem;
+	*copy     = *node;
+	copy->buf = NULL;
+	memcpy(copy + 1, node->buf, node->n_bytes);
+	mem[sizeof(SerdNode) + node->n_bytes] = '\0';
+	return off;
+}
+
+static const SerdNode*
+recorded_node(const Chunk* chunk, size_t off)
+{
+	if (!off) {
+		return NULL;
+	}
+
+	SerdNode* const node = (SerdNode*)(chunk->arena.buf + off);
+	node->buf = (const uint8_t*)(node + 1);
+	return node;
+}
+
+static Event*
+add_event(Chunk* chunk, EventType type)
+{
+	if (chunk->n_events == chunk->max_events) {
+		chunk->max_events = chunk->max_events ? chunk->max_events * 2 : 256;
+		chunk->events     = (Event*)realloc(
+			chunk->events, chunk->max_events * sizeof(Event));
+	}
+
+	Event* const event = &chunk->events[chunk->n_events++];
+	memset(event, '\0', sizeof(Event));
+	event->type = type;
+	return event;
+}
+
+static SerdStatus
+record_base(void* handle, const SerdNode* uri)
+{
+	Chunk* const chunk = (Chunk*)handle;
+	Event* const event = add_event(chunk, EVENT_BASE);
+
+	event->nodes[0] = record_node(chunk, uri);
+	return SERD_SUCCESS;
+}
+
+static SerdStatus
+record_prefix(void* handle, const SerdNode* name, const SerdNode* uri)
+{
+	Chunk* const chunk = (Chunk*)handle;
+	Event* const event = add_event(chunk, EVENT_PREFIX);
+
+	event->nodes[0] = record_node(chunk, name);
+	event->nodes[1] = record_node(chunk, uri);
+	return SERD_SUCCESS;
+}
+
+static SerdStatus
+record_statement(void*              handle,
+                 SerdStatementFlags flags,
+                 const SerdNode*    graph,
+                 const SerdNode*    subject,
+                 const SerdNode*    predicate,
+                 const SerdNode*    object,
+                 const SerdNode*    object_datatype,
+                 const SerdNode*    object_lang)
+{
+	Chunk* const chunk = (Chunk*)handle;
+	Event* const event = add_event(chunk, EVENT_STATEMENT);
+
+	event->flags    = flags;
+	event->nodes[0] = record_node(chunk, graph);
+	event->nodes[1] = record_node(chunk, subject);
+	event->nodes[2] = record_node(chunk, predicate);
+	event->nodes[3] = record_node(chunk, object);
+	event->nodes[4] = record_node(chunk, object_datatype);
+	event->nodes[5] = record_node(chunk, object_lang);
+	return SERD_SUCCESS;
+}
+
+static SerdStatus
+record_end(void* handle, const SerdNode* node)
+{
+	Chunk* const chunk = (Chunk*)handle;
+	Event* const event = add_event(chunk, EVENT_END);
+
+	event->nodes[0] = record_node(chunk, node);
+	return SERD_SUCCESS;
+}
+
+static SerdStatus
+record_undefined(void* handle, const SerdNode* node)
+{
+	Chunk* const chunk = (Chunk*)handle;
+	Event* const event = add_event(chunk, EVENT_UNDEFINED);
+
+	event->nodes[0] = record_node(chunk, node);
+
+	// Define the prefix for the rest of the chunk so it is only checked once
+	const uint8_t* const colon = (const uint8_t*)memchr(
+		node->buf, ':', node->n_bytes);
+	const size_t   len  = (size_t)(colon - node->buf);
+	const SerdNode name = { node->buf, len, len, 0, SERD_LITERAL };
+	const SerdNode uri  = serd_node_from_string(
+		SERD_URI, (const uint8_t*)"undefined:");
+	serd_env_set_prefix(chunk->reader->env, &name, &uri);
+	return SERD_SUCCESS;
+}
+
+static SerdStatus
+record_error(void* handle, const SerdError* e)
+{
+	Chunk* const chunk = (Chunk*)handle;
+	Event* const event = add_event(chunk, EVENT_ERROR);
+
+	event->status = e->status;
+	event->line   = e->line;
+	event->col    = e->col;
+
+	// An error at the end may be due to the chunk ending before the statement
+	if (!serd_byte_source_peek(&chunk->reader->source)) {
+		chunk->dirty = true;
+	}
+
+	va_list args;
+	va_copy(args, *e->args);
+	const int len = vsnprintf(NULL, 0, e->fmt, args);
+	va_end(args);
+
+	const size_t align = sizeof(SerdNode);
+	const size_t size  = len > 0 ? (size_t)len + 1 : 1;
+	event->nodes[0]    = chunk->arena.size;
+	event->nodes[1]    = size - 1;
+	char* const  msg   = (char*)serd_stack_push(
+		&chunk->arena, (size + align - 1) / align * align);
+	msg[0]            = '\0';
+	vsnprintf(msg, size, e->fmt, *e->args);
+	return SERD_SUCCESS;
+}
+
+/// Return true iff the line ending at `nl` ends with a '.'
+static bool
+ends_with_dot(const Parallel* par, const uint8_t* nl)
+{
+	const uint8_t* p = nl;
+	while (p > par->input && (p[-1] == ' ' || p[-1] == '\t' || p[-1] == '\r')) {
+		--p;
+	}
+
+	return p > par->input && p[-1] == '.';
+}
+
+/// Return the offset of the start of the chunk with index `i`
+static size_t
+chunk_start(const Parallel* par, size_t i)
+{
+	if (i == 0) {
+		return 0;
+	} else if (i >= par->n_chunks) {
+		return par->size;
+	}
+
+	const uint8_t*       p   = par->input + i * par->chunk_size - 1;
+	const uint8_t* const end = par->input + par->size;
+	for (; (p = (const uint8_t*)memchr(p, '\n', end - p)); ++p) {
+		if (par->line_based || ends_with_dot(par, p)) {
+			return (size_t)(p - par->input) + 1;
+		}
+	}
+
+	return par->size;
+}
+
+/// Return true iff `user` has any sink for statements
+static bool
+takes_statements(const SerdReader* user)
+{
+	return user->statement_sink || user->batch.sink || user->terms.sink;
+}
+
+static SerdReader*
+new_chunk_reader(const Parallel* par)
+{
+	const SerdReader* const user   = par->reader;
+	SerdReader* const       reader = serd_reader_new(
+		user->syntax, NULL, NULL,
+		(user->base_sink || user->validating) ? record_base : NULL,
+		(user->prefix_sink || user->validating) ? record_prefix : NULL,
+		takes_statements(user) ? record_statement : NULL,
+		user->end_sink ? record_end : NULL);
+
+	reader->undefined_sink = record_undefined;
+	serd_reader_set_strict(reader, user->strict);
+	serd_reader_set_node_views(reader, true);
+	serd_reader_set_validate_only(reader, user->validating);
+	serd_reader_set_stack_policy(reader, 0, user->stack.growth, user->high_water);
+	serd_reader_set_error_sink(reader, record_error, NULL);
+	serd_reader_set_blank_id_radix(reader, user->id_radix);
+	serd_reader_add_blank_prefix(reader, user->bprefix);
+	if (user->default_graph.buf) {
+		serd_reader_set_default_graph(reader, &user->default_graph);
+	}
+
+	return reader;
+}
+
+/** Record the stack usage of a chunk reader, with the mutex held. */
+static void
+note_stack_peak(Parallel* par, const SerdReader* reader)
+{
+	const size_t peak = serd_stack_peak(&reader->stack);
+	if (peak > par->stack_peak) {
+		par->stack_peak = peak;
+	}
+}
+
+static void
+read_chunk(const Parallel* par,
+           SerdReader*     reader,
+           Chunk*          chunk,
+           unsigned        first_id,
+           bool            seen_genid)
+{
+	chunk->arena.size    = SERD_STACK_BOTTOM;
+	chunk->n_events      = 0;
+	chunk->reader        = reader;
+	chunk->first_id      = first_id;
+	chunk->dirty         = false;
+	reader->handle       = chunk;
+	reader->error_handle = chunk;
+	reader->next_id      = first_id;
+	reader->seen_genid   = seen_genid;
+	reader->seen_Bgenid  = false;
+	reader->skipping     = false;
+	reader->error_ended  = false;
+	memset(&reader->skip, '\0', sizeof(SkipState));
+	if (reader->validating) {
+		// Only prefixes defined in this chunk are known when checking names
+		serd_env_free(reader->env);
+		reader->env = serd_env_new(NULL);
+	}
+
+	const SerdReaderStats before = reader->stats;
+
+	// Chunks after the first start at the beginning of a line (column 0)
+	const Cursor cur = { par->name, 1, chunk->begin ? 0U : 1U, chunk->begin };
+
+	chunk->status = serd_reader_read_range(
+		reader, par->input + chunk->begin, chunk->end - chunk->begin, cur, NULL);
+
+	// Reading ended while skipping an error, which may end in the next chunk
+	chunk->dirty = chunk->dirty || reader->skipping;
+
+	chunk->n_ids        = reader->next_id - first_id;
+	chunk->n_bytes      = reader->stats.n_bytes - before.n_bytes;
+	chunk->n_nodes      = reader->stats.n_nodes - before.n_nodes;
+	chunk->n_statements = reader->stats.n_statements - before.n_statements;
+	chunk->seen_genid   = reader->seen_genid;
+	chunk->seen_Bgenid  = reader->seen_Bgenid;
+}
+
+/// Wait for a chunk to be read, and return the error of any thread sink
+static SerdStatus
+wait_for_chunk(Parallel* par, const Chunk* chunk)
+{
+	pthread_mutex_lock(&par->mutex);
+	while (!chunk->done && !par->sink_status) {
+		pthread_cond_wait(&par->cond, &par->mutex);
+	}
+	const SerdStatus st = par->sink_status;
+	pthread_mutex_unlock(&par->mutex);
+	return st;
+}
+
+/// Wait for all pending statements to be passed on, and return any error
+static SerdStatus
+wait_for_pending(Parallel* par)
+{
+	pthread_mutex_lock(&par->mutex);
+	while (par->n_pending && !par->sink_status) {
+		pthread_cond_wait(&par->cond, &par->mutex);
+	}
+	const SerdStatus st = par->sink_status;
+	pthread_mutex_unlock(&par->mutex);
+	return st;
+}
+
+/// Return the number of lines before `offset`, which increases with each call
+static unsigned
+count_lines(Parallel* par, size_t offset)
+{
+	const uint8_t*       p   = par->input + par->line_offset;
+	const uint8_t* const end = par->input + offset;
+	for (; (p = (const uint8_t*)memchr(p, '\n', end - p)); ++p) {
+		++par->line_count;
+	}
+
+	par->line_offset = offset;
+	return par->line_count;
+}
+
+static void
+emit_error(SerdReader*    reader,
+           SerdStatus     status,
+           const uint8_t* name,
+           unsigned       line,
+           unsigned       col,
+           const char*    fmt,
+           ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	const SerdError e = { status, name, line, col, fmt, &args };
+	serd_error(reader->error_sink, reader->error_handle, &e);
+	va_end(args);
+}
+
+/// Pass a recorded error message, which may contain null bytes, on
+static void
+emit_message(Parallel* par, const Chunk* chunk, const Event* e)
+{
+	if (!serd_reader_count_error(par->reader, e->status)) {
+		return;
+	}
+
+	const char* const msg = (const char*)chunk->arena.buf + e->nodes[0];
+	const size_t      len = e->nodes[1];
+
+	// Escape the message as a format string with null bytes as arguments
+	char* const fmt     = (char*)malloc(2 * len + 1);
+	size_t      n       = 0;
+	unsigned    n_nulls = 0;
+	for (size_t i = 0; i < len; ++i) {
+		if (msg[i] == '%' || (!msg[i] && n_nulls++ < 4)) {
+			fmt[n++] = '%';
+			fmt[n++] = msg[i] ? '%' : 'c';
+		} else if (msg[i]) {
+			fmt[n++] = msg[i];
+		}
+	}
+	fmt[n] = '\0';
+
+	const unsigned line = count_lines(par, chunk->begin) + e->line;
+	emit_error(par->reader, e->status, par->name, line, e->col, fmt, 0, 0, 0, 0);
+	free(fmt);
+}
+
+/**
+   Return the recorded node at `off`, with a generated blank ID renumbered.
+
+   The renumbered node is copied to `copy` and `buf`, which must have space
+   for a generated ID.
+*/
+static const SerdNode*
+emitted_node(const Parallel* par,
+             const Chunk*    chunk,
+             size_t          off,
+             unsigned        id_offset,
+             SerdNode*       copy,
+             char*           buf)
+{
+	const SerdNode* const   node   = recorded_node(chunk, off);
+	const SerdReader* const reader = par->reader;
+	if (!id_offset || !node || node->type != SERD_BLANK ||
+	    node->n_bytes < reader->bprefix_len + 2 ||
+	    node->buf[reader->bprefix_len] != 'b') {
+		return node;
+	}
+
+	// Only generated IDs are `b' followed by digits, labels are renamed
+	const size_t   len = node->n_bytes - reader->bprefix_len - 1;
+	const unsigned id  = parse_genid(
+		reader, (const char*)node->buf + reader->bprefix_len + 1, len);
+	if (!id) {
+		return node;
+	}
+
+	*copy          = *node;
+	copy->buf      = (const uint8_t*)buf;
+	copy->n_bytes  = copy->n_chars = write_genid(reader, buf, id + id_offset);
+	return copy;
+}
+
+/**
+   Pass statements of a chunk to the statement sink with `handle`.
+
+   Only the first `n_events` events which the chunk's reader would pass on,
+   which does not include checks of undefined prefixes, are considered.
+*/
+static SerdStatus
+pass_statements(const Parallel* par,
+                const Chunk*    chunk,
+                size_t          n_events,
+                void*           handle,
+                char*           ids)
+{
+	const SerdReader* const reader  = par->reader;
+	const size_t            id_size = genid_size(par->reader);
+	SerdNode                copies[6];
+	const SerdNode*         n[6];
+
+	for (size_t i = 0; i < chunk->n_events && n_events; ++i) {
+		const Event* const e = &chunk->events[i];
+		if (e->type == EVENT_UNDEFINED) {
+			continue;
+		}
+
+		--n_events;
+		if (e->type != EVENT_STATEMENT) {
+			continue;
+		}
+
+		for (size_t j = 0; j < 6; ++j) {
+			n[j] = emitted_node(par, chunk, e->nodes[j], chunk->id_offset,
+			                    &copies[j], ids + j * id_size);
+		}
+
+		const SerdStatus st = reader->statement_sink(
+			handle, e->flags, n[0], n[1], n[2], n[3], n[4], n[5]);
+		if (st) {
+			return st;
+		}
+	}
+
+	return SERD_SUCCESS;
+}
+
+/// Return a chunk with statements for a thread sink, with the mutex held
+static Chunk*
+next_pending(const Parallel* par)
+{
+	for (size_t i = 0; i < par->n_slots && par->n_pending; ++i) {
+		Chunk* const chunk = &par->chunks[i];
+		if (chunk->pending && !chunk->claimed) {
+			return chunk;
+		}
+	}
+
+	return NULL;
+}
+
+/// Return true iff a worker can read the next chunk, with the mutex held
+static bool
+can_read(const Parallel* par)
+{
+	return par->next_read < par->n_chunks &&
+	       par->next_read < par->next_emit + par->n_slots &&
+	       !par->chunks[par->next_read % par->n_slots].pending;
+}
+
+/// Return true iff a worker has nothing more to do, with the mutex held
+static bool
+worker_done(const Parallel* par)
+{
+	// With thread sinks, there may be statements to pass on until stopped
+	return par->stop || (!par->per_thread && par->next_read >= par->n_chunks);
+}
+
+static void*
+read_chunks(void* arg)
+{
+	const Worker* const worker = (const Worker*)arg;
+	Parallel* const     par    = worker->par;
+	SerdReader* const   reader = new_chunk_reader(par);
+	char* const         ids    = (par->per_thread
+	                              ? (char*)malloc(6 * genid_size(par->reader))
+	                              : NULL);
+
+	pthread_mutex_lock(&par->mutex);
+	while (true) {
+		Chunk* pending = NULL;
+		while (!worker_done(par) && !(pending = next_pending(par)) &&
+		       !can_read(par)) {
+			pthread_cond_wait(&par->cond, &par->mutex);
+		}
+
+		if (pending) {
+			pending->claimed = true;
+			pthread_mutex_unlock(&par->mutex);
+
+			const SerdStatus st = pass_statements(
+				par, pending, pending->n_events, worker->handle, ids);
+
+			pthread_mutex_lock(&par->mutex);
+			pending->pending = pending->claimed = false;
+			--par->n_pending;
+			if (st && !par->sink_status) {
+				par->sink_status = st;
+				par->stop        = true;
+			}
+			pthread_cond_broadcast(&par->cond);
+			continue;
+		} else if (worker_done(par)) {
+			break;
+		}
+
+		const size_t i     = par->next_read++;
+		Chunk* const chunk = &par->chunks[i % par->n_slots];
+		pthread_mutex_unlock(&par->mutex);
+
+		chunk->begin = chunk_start(par, i);
+		chunk->end   = chunk_start(par, i + 1);
+		read_chunk(par, reader, chunk, 1, false);
+
+		pthread_mutex_lock(&par->mutex);
+		chunk->done = true;
+		pthread_cond_broadcast(&par->cond);
+	}
+	note_stack_peak(par, reader);
+	pthread_mutex_unlock(&par->mutex);
+
+	serd_reader_free(reader);
+	free(ids);
+	return NULL;
+}
+
+/**
+   Pass the results of a chunk to the user's reader.
+
+   Returns the number of events passed on, which is less than the number of
+   events in the chunk if a sink returned an error, which is stored in `st`,
+   or a name has a prefix which was not defined in the chunk or before it.
+   With thread sinks, statements are only counted, to be passed on later.
+*/
+static size_t
+emit_chunk(Parallel* par, const Chunk* chunk, SerdStatus* st)
+{
+	SerdReader* const reader    = par->reader;
+	const unsigned    id_offset = chunk->id_offset;
+	const size_t      id_size   = genid_size(reader);
+	size_t            n_checks  = 0;
+	SerdNode          copies[6];
+	const SerdNode*   n[6];
+
+	for (size_t i = 0; i < chunk->n_events; ++i) {
+		const Event* const e = &chunk->events[i];
+		if (e->type == EVENT_ERROR) {
+			emit_message(par, chunk, e);
+			continue;
+		} else if (e->type == EVENT_UNDEFINED) {
+			SerdChunk prefix;
+			SerdChunk suffix;
+			if (serd_env_expand(reader->env,
+			                    recorded_node(chunk, e->nodes[0]),
+			                    &prefix,
+			                    &suffix)) {
+				return i - n_checks;  // Read again to report the error in place
+			}
+
+			++n_checks;
+			continue;
+		} else if (e->type == EVENT_STATEMENT && par->per_thread) {
+			serd_reader_count_statement(reader);
+			continue;
+		}
+
+		for (size_t j = 0; j < 6; ++j) {
+			n[j] = emitted_node(par, chunk, e->nodes[j], id_offset,
+			                    &copies[j], par->ids + j * id_size);
+		}
+
+		switch (e->type) {
+		case EVENT_BASE:
+			serd_reader_emit_base(reader, n[0]);
+			break;
+		case EVENT_PREFIX:
+			*st = serd_reader_emit_prefix(reader, n[0], n[1]);
+			break;
+		case EVENT_STATEMENT:
+			*st = serd_reader_emit_statement(
+				reader, e->flags, n[0], n[1], n[2], n[3], n[4], n[5]);
+			break;
+		default:
+			serd_reader_emit_end(reader, n[0]);
+		}
+
+		if (*st) {
+			return i - n_checks;
+		}
+	}
+
+	return chunk->n_events;
+}
+
+/// Return true iff the next event was already passed on, and set `st`
+static bool
+replay_skip(Replay* replay, SerdStatus* st)
+{
+	if (replay->n_skip) {
+		--replay->n_skip;
+		return true;
+	} else if (replay->status) {
+		*st            = replay->status;
+		replay->status = SERD_SUCCESS;
+		return true;
+	}
+
+	return false;
+}
+
+static SerdStatus
+replay_base(void* handle, const SerdNode* uri)
+{
+	Replay* const replay = (Replay*)handle;
+	SerdStatus    st     = SERD_SUCCESS;
+	if (replay_skip(replay, &st)) {
+		return st;
+	}
+
+	return serd_reader_emit_base(replay->reader, uri);
+}
+
+static SerdStatus
+replay_prefix(void* handle, const SerdNode* name, const SerdNode* uri)
+{
+	Replay* const replay = (Replay*)handle;
+	SerdStatus    st     = SERD_SUCCESS;
+	return replay_skip(replay, &st)
+		? st
+		: serd_reader_emit_prefix(replay->reader, name, uri);
+}
+
+static SerdStatus
+replay_statement(void*              handle,
+                 SerdStatementFlags flags,
+                 const SerdNode*    graph,
+                 const SerdNode*    subject,
+                 const SerdNode*    predicate,
+                 const SerdNode*    object,
+                 const SerdNode*    object_datatype,
+                 const SerdNode*    object_lang)
+{
+	Replay* const replay = (Replay*)handle;
+	SerdStatus    st     = SERD_SUCCESS;
+	if (replay_skip(replay, &st)) {
+		return st;
+	} else if (replay->per_thread) {
+		serd_reader_count_statement(replay->reader);
+		return replay->reader->statement_sink(replay->handle,
+		                                      flags,
+		                                      graph,
+		                                      subject,
+		                                      predicate,
+		                                      object,
+		                                      object_datatype,
+		                                      object_lang);
+	}
+
+	return serd_reader_emit_statement(replay->reader,
+	                                  flags,
+	                                  graph,
+	                                  subject,
+	                                  predicate,
+	                                  object,
+	                                  object_datatype,
+	                                  object_lang);
+}
+
+static SerdStatus
+replay_end(void* handle, const SerdNode* node)
+{
+	Replay* const replay = (Replay*)handle;
+	SerdStatus    st     = SERD_SUCCESS;
+	if (replay_skip(replay, &st)) {
+		return st;
+	}
+
+	return serd_reader_emit_end(replay->reader, node);
+}
+
+static SerdStatus
+replay_error(void* handle, const SerdError* e)
+{
+	Replay* const replay = (Replay*)handle;
+	SerdStatus    st     = SERD_SUCCESS;
+	if (!replay_skip(replay, &st) &&
+	    serd_reader_count_error(replay->reader, e->status)) {
+		serd_error(replay->reader->error_sink, replay->reader->error_handle, e);
+	}
+	return SERD_SUCCESS;
+}
+
+/**
+   Read the rest of the input, from the start of `chunk`, on this thread.
+
+   The first `n_skip` events were already passed on, and the next was
+   rejected by a sink with `status`.
+*/
+static SerdStatus
+read_rest(Parallel*    par,
+          const Chunk* chunk,
+          unsigned*    next_id,
+          bool         seen_genid,
+          size_t       n_skip,
+          SerdStatus   status)
+{
+	SerdReader* const user   = par->reader;
+	void* const       handle = par->per_thread ? user->thread_handles[0] : NULL;
+	Replay            replay = { user, par->per_thread, handle, n_skip, status };
+	SerdReader* const reader = serd_reader_new(
+		user->syntax, &replay, NULL,
+		(user->base_sink || user->validating) ? replay_base : NULL,
+		(user->prefix_sink || user->validating) ? replay_prefix : NULL,
+		takes_statements(user) ? replay_statement : NULL,
+		user->end_sink ? replay_end : NULL);
+
+	serd_reader_set_strict(reader, user->strict);
+	serd_reader_set_node_views(reader, user->node_views);
+	serd_reader_set_validate_only(reader, user->validating);
+	serd_reader_set_stack_policy(reader, 0, user->stack.growth, user->high_water);
+	serd_reader_set_error_sink(reader, replay_error, &replay);
+	serd_reader_set_blank_id_radix(reader, user->id_radix);
+	serd_reader_add_blank_prefix(reader, user->bprefix);
+	if (user->default_graph.buf) {
+		serd_reader_set_default_graph(reader, &user->default_graph);
+	}
+
+	reader->next_id    = *next_id;
+	reader->seen_genid = seen_genid;
+	serd_reader_set_env(reader, user->env);  // Names may use earlier prefixes
+
+	const Cursor cur = { par->name,
+	                     count_lines(par, chunk->begin) + 1,
+	                     chunk->begin ? 0U : 1U,
+	                     chunk->begin };
+
+	const SerdStatus st = serd_reader_read_range(
+		reader, par->input + chunk->begin, par->size - chunk->begin, cur, NULL);
+
+	*next_id         = reader->next_id;
+	user->seen_genid = reader->seen_genid;
+
+	user->stats.n_bytes += reader->stats.n_bytes;
+	user->stats.n_nodes += reader->stats.n_nodes;
+	if (user->validating) {
+		user->stats.n_statements += reader->stats.n_statements;
+	}
+	if (reader->checkpoint.cur.offset > chunk->begin) {
+		serd_reader_set_checkpoint(user,
+		                           reader->checkpoint.cur,
+		                           reader->checkpoint.next_id,
+		                           reader->checkpoint.seen_genid);
+	}
+
+	pthread_mutex_lock(&par->mutex);
+	note_stack_peak(par, reader);
+	pthread_mutex_unlock(&par->mutex);
+
+	serd_reader_free(reader);
+	return st;
+}
+
+static SerdStatus
+read_parallel(Parallel* par, unsigned n_threads)
+{
+	SerdStatus  st         = SERD_SUCCESS;
+	SerdReader* reader     = new_chunk_reader(par);
+	unsigned    next_id    = par->reader->next_id;
+	bool        seen_genid = par->reader->seen_genid;
+
+	void* const* const handles = par->reader->thread_handles;
+	pthread_t* const   threads = (pthread_t*)calloc(n_threads, sizeof(pthread_t));
+	Worker* const      workers = (Worker*)calloc(n_threads, sizeof(Worker));
+	unsigned           n_started = 0;
+	for (; n_started < n_threads; ++n_started) {
+		workers[n_started].par    = par;
+		workers[n_started].handle = par->per_thread ? handles[n_started] : NULL;
+		if (pthread_create(
+			    &threads[n_started], NULL, read_chunks, &workers[n_started])) {
+			break;
+		}
+	}
+
+	for (size_t i = 0; i < par->n_chunks && !st;) {
+		Chunk* const chunk = &par->chunks[i % par->n_slots];
+		if (n_started) {
+			if ((st = wait_for_chunk(par, chunk))) {
+				break;  // A thread sink failed
+			}
+		} else {  // No threads could be started, read chunks here
+			chunk->begin = chunk_start(par, i);
+			chunk->end   = chunk_start(par, i + 1);
+			read_chunk(par, reader, chunk, 1, false);
+		}
+
+		// Read again, with following chunks if necessary, to match a single read
+		size_t next = i + 1;
+		while ((chunk->dirty && next < par->n_chunks) ||
+		       (par->line_based && chunk->n_ids && chunk->first_id != next_id) ||
+		       (chunk->seen_Bgenid && seen_genid)) {
+			if (chunk->dirty && next < par->n_chunks) {
+				chunk->end = chunk_start(par, ++next);
+			}
+
+			read_chunk(par, reader, chunk,
+			           par->line_based ? next_id : 1, seen_genid);
+		}
+
+		// Wait for any following chunks that were read in vain to be freed
+		pthread_mutex_lock(&par->mutex);
+		for (size_t j = i + 1; j < next && j < par->next_read; ++j) {
+			while (!par->chunks[j % par->n_slots].done) {
+				pthread_cond_wait(&par->cond, &par->mutex);
+			}
+		}
+		pthread_mutex_unlock(&par->mutex);
+
+		chunk->id_offset = chunk->n_ids ? next_id - chunk->first_id : 0;
+
+		SerdStatus   sink_st   = SERD_SUCCESS;
+		const size_t n_emitted = emit_chunk(par, chunk, &sink_st);
+		if (n_emitted < chunk->n_events) {
+			if (par->per_thread && (st = wait_for_pending(par))) {
+				break;
+			} else if (par->per_thread &&
+			           (st = pass_statements(
+				            par, chunk, n_emitted, handles[0], par->ids))) {
+				break;
+			}
+
+			st = read_rest(par, chunk, &next_id, seen_genid, n_emitted, sink_st);
+			break;
+		} else if (par->per_thread && !n_started &&
+		           (st = pass_statements(
+			            par, chunk, chunk->n_events, handles[0], par->ids))) {
+			break;
+		}
+
+		st          = chunk->status;
+		next_id    += chunk->n_ids;
+		seen_genid  = seen_genid || chunk->seen_genid;
+
+		par->reader->stats.n_bytes += chunk->n_bytes;
+		par->reader->stats.n_nodes += chunk->n_nodes;
+		if (par->reader->validating) {
+			// No statements were recorded to be counted as they are passed on
+			par->reader->stats.n_statements += chunk->n_statements;
+		}
+
+		if (!st && !par->per_thread) {
+			// The end of a chunk is a statement boundary, usually a line start
+			unsigned col = 0;
+			for (size_t e = chunk->end; e && par->input[e - 1] != '\n'; --e) {
+				++col;
+			}
+
+			const Cursor end = { par->name,
+			                     count_lines(par, chunk->end) + 1,
+			                     col,
+			                     chunk->end };
+			serd_reader_set_checkpoint(par->reader, end, next_id, seen_genid);
+		}
+
+		pthread_mutex_lock(&par->mutex);
+		for (size_t j = i; j < next; ++j) {
+			par->chunks[j % par->n_slots].done = false;
+		}
+		if (par->per_thread && n_started) {
+			chunk->pending = true;
+			++par->n_pending;
+		}
+		par->next_emit = next;
+		par->next_read = next > par->next_read ? next : par->next_read;
+		par->stop      = par->stop || (st && !par->per_thread);
+		pthread_cond_broadcast(&par->cond);
+		pthread_mutex_unlock(&par->mutex);
+
+		i = next;
+	}
+
+	if (par->per_thread) {
+		// Statements before an error are passed on, as in a sequential read
+		const SerdStatus pst = wait_for_pending(par);
+		st                   = st ? st : pst;
+	}
+
+	pthread_mutex_lock(&par->mutex);
+	par->stop = true;
+	pthread_cond_broadcast(&par->cond);
+	pthread_mutex_unlock(&par->mutex);
+	for (unsigned t = 0; t < n_started; ++t) {
+		pthread_join(threads[t], NULL);
+	}
+
+	note_stack_peak(par, reader);
+	if (par->stack_peak > par->reader->stack.peak) {
+		par->reader->stack.peak = par->stack_peak;
+	}
+
+	par->reader->next_id    = next_id;
+	par->reader->seen_genid = par->reader->seen_genid || seen_genid;
+	serd_reader_free(reader);
+	free(workers);
+	free(threads);
+	return st;
+}
+
+#endif  // HAVE_PTHREAD
+
+SerdStatus
+serd_reader_read_file_parallel(SerdReader*    reader,
+                               FILE*          file,
+                               const uint8_t* name,
+                               unsigned       n_threads)
+{
+#ifdef HAVE_PTHREAD
+	// Statements only go to thread sinks if they would go to the plain sink
+	const bool per_thread = (reader->n_thread_handles && !reader->validating &&
+	                         reader->statement_sink && !reader->batch.sink &&
+	                         !reader->terms.sink);
+	if (per_thread && n_threads > reader->n_thread_handles) {
+		n_threads = reader->n_thread_handles;
+	}
+
+	SerdByteSource source;
+	if (n_threads < 2 || reader->resume.line ||
+	    serd_byte_source_open_mapping(&source, file, name)) {
+		return serd_reader_read_file_handle(reader, file, name);
+	} else if (serd_compression_detect(source.read_buf, source.page_size)) {
+		serd_byte_source_close(&source);  // Decompressed a page at a time
+		return serd_reader_read_file_handle(reader, file, name);
+	}
+
+	// Use several chunks per thread so that work is evenly distributed
+	const size_t size       = source.page_size;
+	size_t       chunk_size = size / n_threads / 8;
+	chunk_size = chunk_size < SERD_CHUNK_SIZE_MIN ? SERD_CHUNK_SIZE_MIN
+	           : chunk_size > SERD_CHUNK_SIZE_MAX ? SERD_CHUNK_SIZE_MAX
+	           : chunk_size;
+
+	Parallel par;
+	memset(&par, '\0', sizeof(par));
+	par.reader     = reader;
+	par.name       = name;
+	par.input      = source.read_buf;
+	par.size       = size;
+	par.chunk_size = chunk_size;
+	par.n_chunks   = (size + chunk_size - 1) / chunk_size;
+	par.line_based = (reader->syntax == SERD_NTRIPLES ||
+	                  reader->syntax == SERD_NQUADS);
+	par.per_thread = per_thread;
+	par.ids        = (char*)malloc(6 * genid_size(reader));
+	par.n_slots    = 2 * (size_t)n_threads;
+	par.chunks     = (Chunk*)calloc(par.n_slots, sizeof(Chunk));
+	for (size_t i = 0; i < par.n_slots; ++i) {
+		par.chunks[i].arena = serd_stack_new(SERD_PAGE_SIZE);
+	}
+
+	pthread_mutex_init(&par.mutex, NULL);
+	pthread_cond_init(&par.cond, NULL);
+
+	const SerdStatus st  = read_parallel(&par, n_threads);
+	const SerdStatus bst = serd_reader_flush_batch(reader);
+
+	pthread_cond_destroy(&par.cond);
+	pthread_mutex_destroy(&par.mutex);
+	for (size_t i = 0; i < par.n_slots; ++i) {
+		serd_stack_free(&par.chunks[i].arena);
+		free(par.chunks[i].events);
+	}
+	free(par.chunks);
+	free(par.ids);
+	serd_byte_source_close(&source);
+
+	return st ? st : bst;
+#else
+	(void)n_threads;
+	return serd_reader_read_file_handle(reader, file, name);
+#endif
+}
@@ -27,8 +27,13 @@
 int
 r_err(SerdReader* reader, SerdStatus st, const char* fmt, ...)
 {
+	if (!serd_reader_count_error(reader, st)) {
+		return 0;  // Only counted, so the position is not needed
+	}
+
 	va_list args;
 	va_start(args, fmt);
+	serd_byte_source_update_cursor(&reader->source);
 	const Cursor* const cur = &reader->source.cur;
 	const SerdError e = { st, cur->filename, cur->line, cur->col, fmt, &args };
 	serd_error(reader->error_sink, reader->error_handle, &e);
@@ -36,13 +41,78 @@ r_err(SerdReader* reader, SerdStatus st, const char* fmt, ...)
 	return 0;
 }
 
+static const char genid_digits[] =
+	"0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+static const char genid_pairs[] =
+	"0001020304050607080910111213141516171819"
+	"2021222324252627282930313233343536373839"
+	"4041424344454647484950515253545556575859"
+	"6061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+size_t
+write_genid(const SerdReader* reader, char* buf, unsigned id)
+{
+	char  digits[12];
+	char* d = digits + sizeof(digits);
+	if (reader->id_radix == 10) {
+		for (; id >= 100; id /= 100) {
+			d -= 2;
+			memcpy(d, genid_pairs + 2 * (id % 100), 2);
+		}
+		if (id >= 10) {
+			d -= 2;
+			memcpy(d, genid_pairs + 2 * id, 2);
+		} else {
+			*--d = (char)('0' + id);
+		}
+	} else {
+		do {
+			*--d = genid_digits[id % reader->id_radix];
+		} while ((id /= reader->id_radix));
+		if (!is_digit((uint8_t)*d)) {
+			*--d = '0';  // Start with a digit so clashing labels are renamed
+		}
+	}
+
+	const size_t n_digits = (size_t)(digits + sizeof(digits) - d);
+	if (reader->bprefix_len) {
+		memcpy(buf, reader->bprefix, reader->bprefix_len);
+	}
+	buf[reader->bprefix_len] = 'b';
+	memcpy(buf + reader->bprefix_len + 1, d, n_digits);
+	buf[reader->bprefix_len + 1 + n_digits] = '\0';
+	return reader->bprefix_len + 1 + n_digits;
+}
+
+unsigned
+parse_genid(const SerdReader* reader, const char* digits, size_t len)
+{
+	if (!len || !is_digit((uint8_t)digits[0])) {
+		return 0;
+	}
+
+	unsigned id = 0;
+	for (size_t i = 0; i < len; ++i) {
+		const char* const d = (const char*)memchr(
+			genid_digits, digits[i], reader->id_radix);
+		if (!d) {
+			return 0;
+		}
+		id = id * reader->id_radix + (unsigned)(d - genid_digits);
+	}
+
+	return id;
+}
+
 void
-set_blank_id(SerdReader* reader, Ref ref, size_t buf_size)
+set_blank_id(SerdReader* reader, Ref ref)
 {
-	SerdNode*   node   = deref(reader, ref);
-	const char* prefix = reader->bprefix ? (const char*)reader->bprefix : "";
-	node->n_bytes = node->n_chars = snprintf(
-		(char*)node->buf, buf_size, "%sb%u", prefix, reader->next_id++);
+	// Blank IDs are always padded nodes, so the string follows the node
+	SerdNode* const node = (SerdNode*)(reader->stack.buf + ref);
+	char* const     buf  = (char*)(node + 1);
+	node->n_bytes = node->n_chars = write_genid(reader, buf, reader->next_id++);
 }
 
 size_t
@@ -55,7 +125,7 @@ Ref
 blank_id(SerdReader* reader)
 {
 	Ref ref = push_node_padded(reader, genid_size(reader), SERD_BLANK, "", 0);
-	set_blank_id(reader, ref, genid_size(reader));
+	set_blank_id(reader, ref);
 	return ref;
 }
 
@@ -82,6 +152,8 @@ push_node_padded(SerdReader* reader, size_t maxlen,
 	void* mem = serd_stack_push_aligned(
 		&reader->stack, sizeof(SerdNode) + maxlen + 1, sizeof(SerdNode));
 
+	++reader->stats.n_nodes;
+
 	SerdNode* const node = (SerdNode*)mem;
 	node->n_bytes = node->n_chars = n_bytes;
 	node->flags   = 0;
@@ -105,12 +177,58 @@ push_node(SerdReader* reader, SerdType type, const char* str, size_t n_bytes)
 	return push_node_padded(reader, n_bytes, type, str, n_bytes);
 }
 
+/**
+   Push a node which refers to a string in the input without copying it.
+
+   The node is tagged in the stack so that deref() points the node at the
+   input, which is stored in place of the node's string.
+*/
+Ref
+push_node_view(SerdReader*    reader,
+               SerdType       type,
+               const uint8_t* buf,
+               size_t         n_bytes,
+               size_t         n_chars)
+{
+	const Ref ref = push_node_padded(reader, sizeof(buf), type, "", 0);
+
+	SerdNode* const node = (SerdNode*)(reader->stack.buf + ref);
+	node->n_bytes = n_bytes;
+	node->n_chars = n_chars;
+	memcpy(node + 1, &buf, sizeof(buf));
+	reader->stack.buf[ref - 1] |= SERD_STACK_TAG;
+	return ref;
+}
+
+void
+pop_to(SerdReader* reader, size_t size)
+{
+#ifdef SERD_STACK_CHECK
+	while (reader->n_allocs && reader->allocs[reader->n_allocs - 1] >= size) {
+		--reader->n_allocs;
+	}
+#endif
+	serd_stack_pop(&reader->stack, reader->stack.size - size);
+}
+
+void
+trim_stack(SerdReader* reader)
+{
+	if (reader->high_water && reader->stack.buf_size > reader->high_water) {
+		serd_stack_resize(&reader->stack, reader->high_water);
+	}
+}
+
 SerdNode*
 deref(SerdReader* reader, const Ref ref)
 {
 	if (ref) {
 		SerdNode* node = (SerdNode*)(reader->stack.buf + ref);
-		node->buf = (uint8_t*)node + sizeof(SerdNode);
+		if (reader->stack.buf[ref - 1] & SERD_STACK_TAG) {
+			memcpy(&node->buf, node + 1, sizeof(node->buf));
+		} else {
+			node->buf = (uint8_t*)node + sizeof(SerdNode);
+		}
 		return node;
 	}
 	return NULL;
@@ -139,20 +257,325 @@ emit_statement(SerdReader* reader, ReadContext ctx, Ref o, Ref d, Ref l)
 	if (!graph && reader->default_graph.buf) {
 		graph = &reader->default_graph;
 	}
-	bool ret = !reader->statement_sink ||
-		!reader->statement_sink(
-			reader->handle, *ctx.flags, graph,
-			deref(reader, ctx.subject), deref(reader, ctx.predicate),
-			deref(reader, o), deref(reader, d), deref(reader, l));
+	bool ret = !serd_reader_emit_statement(
+		reader, *ctx.flags, graph,
+		deref(reader, ctx.subject), deref(reader, ctx.predicate),
+		deref(reader, o), deref(reader, d), deref(reader, l));
 	*ctx.flags &= SERD_ANON_CONT|SERD_LIST_CONT;  // Preserve only cont flags
+	reader->sink_failed = reader->sink_failed || !ret;
 	return ret;
 }
 
+/**
+   Copy `node` into the arena of `batch` and return its offset.
+
+   If `prev` is the offset of an equal node, it is shared instead, which is
+   common since consecutive statements often have the same subject and
+   predicate.
+*/
+static size_t
+batch_node(StatementBatch* batch, const SerdNode* node, size_t prev)
+{
+	if (!node) {
+		return 0;
+	}
+
+	if (prev) {
+		const SerdNode* const p = (const SerdNode*)(batch->arena.buf + prev);
+		if (p->type == node->type && p->n_bytes == node->n_bytes &&
+		    !memcmp(p + 1, node->buf, node->n_bytes)) {
+			return prev;
+		}
+	}
+
+	// Node followed by its string, padded to keep the next node aligned
+	const size_t align  = sizeof(size_t);
+	const size_t size   = sizeof(SerdNode) + node->n_bytes + 1;
+	const size_t offset = batch->arena.size;
+	uint8_t* const buf  = serd_stack_push(
+		&batch->arena, (size + align - 1) / align * align);
+
+	SerdNode* const copy = (SerdNode*)buf;
+	*copy     = *node;
+	copy->buf = NULL;  // Set when the batch is passed on
+	memcpy(copy + 1, node->buf, node->n_bytes);
+	buf[size - 1] = '\0';
+	return offset;
+}
+
+static void
+report_progress(SerdReader* reader)
+{
+	reader->next_progress += reader->progress_interval;
+
+	const SerdReaderStats stats = serd_reader_get_stats(reader);
+	reader->progress_sink(reader->progress_handle, &stats);
+}
+
+void
+serd_reader_count_statement(SerdReader* reader)
+{
+	if (++reader->stats.n_statements == reader->next_progress) {
+		report_progress(reader);
+	}
+}
+
+SerdStatus
+serd_reader_emit_statement(SerdReader*        reader,
+                           SerdStatementFlags flags,
+                           const SerdNode*    graph,
+                           const SerdNode*    subject,
+                           const SerdNode*    predicate,
+                           const SerdNode*    object,
+                           const SerdNode*    object_datatype,
+                           const SerdNode*    object_lang)
+{
+	serd_reader_count_statement(reader);
+
+	StatementBatch* const batch = &reader->batch;
+	if (reader->validating) {
+		return SERD_SUCCESS;
+	} else if (!batch->sink) {
+		if (reader->terms.sink) {
+			return serd_reader_emit_statement_ids(reader, flags, graph,
+			                                      subject, predicate, object,
+			                                      object_datatype, object_lang);
+		} else if (!reader->statement_sink) {
+			return SERD_SUCCESS;
+		} else if (!reader->timed) {
+			return reader->statement_sink(reader->handle, flags, graph,
+			                              subject, predicate, object,
+			                              object_datatype, object_lang);
+		}
+
+		const uint64_t   t0 = serd_time_ns();
+		const SerdStatus st = reader->statement_sink(
+			reader->handle, flags, graph, subject, predicate, object,
+			object_datatype, object_lang);
+		reader->sink_ns += serd_time_ns() - t0;
+		return st;
+	}
+
+	const SerdNode* const nodes[] = { graph, subject, predicate,
+	                                  object, object_datatype, object_lang };
+
+	BatchedStatement* const s    = &batch->statements[batch->n_statements];
+	const BatchedStatement* prev = batch->n_statements ? s - 1 : NULL;
+
+	s->flags = flags;
+	for (unsigned i = 0; i < 6; ++i) {
+		s->nodes[i] = batch_node(batch, nodes[i], prev ? prev->nodes[i] : 0);
+	}
+	++batch->n_statements;
+
+	return (batch->n_statements == batch->size) ? serd_reader_flush_batch(reader)
+	                                            : SERD_SUCCESS;
+}
+
+/// Record a directive for the next checkpoint, or null `name` for a base URI
+static void
+log_directive(SerdReader* reader, const SerdNode* name, const SerdNode* uri)
+{
+	if (reader->env_replaced) {
+		return;  // The whole environment is copied at the next checkpoint
+	}
+
+	Directive* const directives = (Directive*)realloc(
+		reader->directives, (reader->n_directives + 1) * sizeof(Directive));
+	if (!directives) {
+		reader->env_replaced = true;
+		return;
+	}
+
+	Directive* const d = &directives[reader->n_directives++];
+	d->name             = name ? serd_node_copy(name) : SERD_NODE_NULL;
+	d->uri              = serd_node_copy(uri);
+	reader->directives  = directives;
+}
+
+static void
+clear_directives(SerdReader* reader)
+{
+	for (size_t i = 0; i < reader->n_directives; ++i) {
+		serd_node_free(&reader->directives[i].name);
+		serd_node_free(&reader->directives[i].uri);
+	}
+	reader->n_directives = 0;
+}
+
+SerdStatus
+serd_reader_emit_base(SerdReader* reader, const SerdNode* uri)
+{
+	if (!serd_env_set_base_uri(reader->env, uri)) {
+		log_directive(reader, NULL, uri);
+	}
+
+	if (!reader->base_sink) {
+		return SERD_SUCCESS;
+	}
+
+	SerdStatus st = serd_reader_flush_batch(reader);
+	if (!st) {
+		const uint64_t t0 = reader->timed ? serd_time_ns() : 0;
+		st = reader->base_sink(reader->handle, uri);
+		if (reader->timed) {
+			reader->sink_ns += serd_time_ns() - t0;
+		}
+	}
+
+	reader->sink_failed = reader->sink_failed || st;
+	return st;
+}
+
+SerdStatus
+serd_reader_emit_prefix(SerdReader*     reader,
+                        const SerdNode* name,
+                        const SerdNode* uri)
+{
+	if (!serd_env_set_prefix(reader->env, name, uri)) {
+		log_directive(reader, name, uri);
+	}
+
+	if (!reader->prefix_sink) {
+		return SERD_SUCCESS;
+	}
+
+	SerdStatus st = serd_reader_flush_batch(reader);
+	if (!st) {
+		const uint64_t t0 = reader->timed ? serd_time_ns() : 0;
+		st = reader->prefix_sink(reader->handle, name, uri);
+		if (reader->timed) {
+			reader->sink_ns += serd_time_ns() - t0;
+		}
+	}
+
+	reader->sink_failed = reader->sink_failed || st;
+	return st;
+}
+
+SerdStatus
+serd_reader_emit_end(SerdReader* reader, const SerdNode* node)
+{
+	if (reader->validating) {
+		return SERD_SUCCESS;
+	}
+
+	SerdStatus st = serd_reader_flush_batch(reader);
+	if (!st) {
+		const uint64_t t0 = reader->timed ? serd_time_ns() : 0;
+		st = reader->end_sink(reader->handle, node);
+		if (reader->timed) {
+			reader->sink_ns += serd_time_ns() - t0;
+		}
+	}
+
+	reader->sink_failed = reader->sink_failed || st;
+	return st;
+}
+
+static SerdEnv*
+copy_env(const SerdEnv* env)
+{
+	const SerdNode* const base = serd_env_get_base_uri(env, NULL);
+	SerdEnv* const        copy = serd_env_new(base->buf ? base : NULL);
+	serd_env_foreach(env, (SerdPrefixSink)serd_env_set_prefix, copy);
+	return copy;
+}
+
+void
+serd_reader_set_env(SerdReader* reader, const SerdEnv* env)
+{
+	serd_env_free(reader->env);
+	reader->env          = copy_env(env);
+	reader->env_replaced = true;
+	clear_directives(reader);
+}
+
+void
+serd_reader_set_checkpoint(SerdReader* reader,
+                           Cursor      cur,
+                           unsigned    next_id,
+                           bool        seen_genid)
+{
+	Checkpoint* const cp = &reader->checkpoint;
+	cp->cur        = cur;
+	cp->next_id    = next_id;
+	cp->seen_genid = seen_genid;
+	if (reader->env_replaced) {
+		serd_env_free(cp->env);
+		cp->env              = copy_env(reader->env);
+		reader->env_replaced = false;
+	} else {
+		// Apply directives in order, so relative URIs resolve the same way
+		for (size_t i = 0; i < reader->n_directives; ++i) {
+			const Directive* const d = &reader->directives[i];
+			if (d->name.buf) {
+				serd_env_set_prefix(cp->env, &d->name, &d->uri);
+			} else {
+				serd_env_set_base_uri(cp->env, &d->uri);
+			}
+		}
+	}
+	clear_directives(reader);
+}
+
+Cursor
+serd_reader_start_cursor(SerdReader* reader, const uint8_t* name)
+{
+	const Cursor start = { name, 1, 1, 0 };
+	Cursor       cur   = reader->resume.line ? reader->resume : start;
+
+	cur.filename        = name;
+	reader->resume.line = 0;
+	return cur;
+}
+
+SerdStatus
+serd_reader_flush_batch(SerdReader* reader)
+{
+	StatementBatch* const batch = &reader->batch;
+	if (!batch->n_statements) {
+		return SERD_SUCCESS;
+	}
+
+	// Resolve offsets now that the arena will not move
+	uint8_t* const arena = batch->arena.buf;
+	for (size_t i = 0; i < batch->n_statements; ++i) {
+		const BatchedStatement* const s    = &batch->statements[i];
+		const SerdNode*               n[6] = { NULL, NULL, NULL,
+		                                       NULL, NULL, NULL };
+		for (unsigned j = 0; j < 6; ++j) {
+			if (s->nodes[j]) {
+				SerdNode* const node = (SerdNode*)(arena + s->nodes[j]);
+				node->buf            = (const uint8_t*)(node + 1);
+				n[j]                 = node;
+			}
+		}
+
+		const SerdStatement statement = { s->flags, n[0], n[1],
+		                                  n[2], n[3], n[4], n[5] };
+		batch->out[i] = statement;
+	}
+
+	const uint64_t   t0 = reader->timed ? serd_time_ns() : 0;
+	const SerdStatus st = batch->sink(
+		reader->handle, batch->out, batch->n_statements);
+	if (reader->timed) {
+		reader->sink_ns += serd_time_ns() - t0;
+	}
+
+	batch->n_statements = 0;
+	batch->arena.size   = SERD_STACK_BOTTOM;
+	return st;
+}
+
 static bool
 read_statement(SerdReader* reader)
 {
 	switch (reader->syntax) {
-	default: return read_n3_statement(reader);
+	case SERD_NTRIPLES:
+	case SERD_NQUADS:   return read_line_statement(reader);
+	default:            return read_n3_statement(reader);
 	}
 }
 
@@ -160,8 +583,9 @@ static bool
 read_doc(SerdReader* reader)
 {
 	switch (reader->syntax) {
-	case SERD_NQUADS: return read_nquadsDoc(reader);
-	default:          return read_turtleTrigDoc(reader);
+	case SERD_NTRIPLES:
+	case SERD_NQUADS:   return read_nquadsDoc(reader);
+	default:            return read_turtleTrigDoc(reader);
 	}
 }
 
@@ -185,11 +609,21 @@ serd_reader_new(SerdSyntax        syntax,
 	me->stack            = serd_stack_new(SERD_PAGE_SIZE);
 	me->syntax           = syntax;
 	me->next_id          = 1;
+	me->id_radix         = 10;
 	me->strict           = true;
+	me->page_size        = SERD_PAGE_SIZE;
+	me->env              = serd_env_new(NULL);
+	me->next_progress    = UINT64_MAX;
+	me->errors_left      = UINT64_MAX;
+
+	const Checkpoint start = { { NULL, 1, 1, 0 }, 1, false, NULL };
+	me->checkpoint     = start;
+	me->checkpoint.env = serd_env_new(NULL);
 
 	me->rdf_first = push_node(me, SERD_URI, NS_RDF "first", 48);
 	me->rdf_rest  = push_node(me, SERD_URI, NS_RDF "rest", 47);
 	me->rdf_nil   = push_node(me, SERD_URI, NS_RDF "nil", 46);
+	me->stats.n_nodes = 0;  // Count only nodes which are read
 
 	return me;
 }
@@ -200,6 +634,138 @@ serd_reader_set_strict(SerdReader* reader, bool strict)
 	reader->strict = strict;
 }
 
+void
+serd_reader_set_node_views(SerdReader* reader, bool node_views)
+{
+	reader->node_views = node_views;
+}
+
+void
+serd_reader_set_validate_only(SerdReader* reader, bool validate_only)
+{
+	reader->validating = validate_only;
+}
+
+void
+serd_reader_set_page_size(SerdReader* reader, size_t page_size)
+{
+	reader->page_size = page_size;
+}
+
+void
+serd_reader_set_stack_policy(SerdReader* reader,
+                             size_t      initial_size,
+                             double      growth,
+                             size_t      high_water)
+{
+	reader->stack.growth = growth > 1.0 ? growth : SERD_STACK_GROWTH;
+	reader->high_water   = high_water;
+	if (initial_size) {
+		serd_stack_resize(&reader->stack, initial_size);
+	}
+}
+
+size_t
+serd_reader_get_stack_peak(const SerdReader* reader)
+{
+	return serd_stack_peak(&reader->stack);
+}
+
+SerdReaderStats
+serd_reader_get_stats(const SerdReader* reader)
+{
+	SerdReaderStats stats = reader->stats;
+	if (reader->source.prepared) {
+		stats.n_bytes += (serd_byte_source_position(&reader->source) -
+		                  reader->source_start);
+	}
+
+	stats.stack_peak = serd_stack_peak(&reader->stack);
+	stats.sink_time  = (double)reader->sink_ns * 1e-9;
+	return stats;
+}
+
+uint64_t
+serd_reader_get_error_count(const SerdReader* reader, SerdStatus status)
+{
+	return (unsigned)status <= SERD_ERR_INTERNAL ? reader->n_errors[status] : 0;
+}
+
+void
+serd_reader_set_sink_timing(SerdReader* reader, bool timed)
+{
+	reader->timed = timed;
+}
+
+void
+serd_reader_set_progress_sink(SerdReader*      reader,
+                              SerdProgressSink progress_sink,
+                              void*            handle,
+                              uint64_t         interval)
+{
+	const bool enabled = progress_sink && interval;
+
+	reader->progress_sink     = progress_sink;
+	reader->progress_handle   = handle;
+	reader->progress_interval = interval;
+	reader->next_progress     = (enabled ? reader->stats.n_statements + interval
+	                                     : UINT64_MAX);
+}
+
+void
+serd_reader_set_read_ahead(SerdReader* reader, unsigned n_pages)
+{
+	reader->read_ahead = n_pages;
+}
+
+void
+serd_reader_set_thread_handles(SerdReader*  reader,
+                               void* const* handles,
+                               unsigned     n_handles)
+{
+	reader->thread_handles   = n_handles ? handles : NULL;
+	reader->n_thread_handles = handles ? n_handles : 0;
+}
+
+static void
+free_batch(StatementBatch* batch)
+{
+	free(batch->statements);
+	free(batch->out);
+	serd_stack_free(&batch->arena);
+	memset(batch, '\0', sizeof(*batch));
+}
+
+SerdStatus
+serd_reader_set_statement_batch_sink(SerdReader*            reader,
+                                     SerdStatementBatchSink batch_sink,
+                                     size_t                 batch_size)
+{
+	StatementBatch* const batch = &reader->batch;
+
+	const SerdStatus st = serd_reader_flush_batch(reader);
+	free_batch(batch);
+
+	if (batch_sink) {
+		batch->sink       = batch_sink;
+		batch->size       = batch_size ? batch_size : 4096;
+		batch->statements = (BatchedStatement*)calloc(
+			batch->size, sizeof(BatchedStatement));
+		batch->out        = (SerdStatement*)calloc(
+			batch->size, sizeof(SerdStatement));
+		batch->arena      = serd_stack_new(SERD_PAGE_SIZE);
+	}
+
+	reader->sink_failed = reader->sink_failed || st;
+	return st;
+}
+
+void
+serd_reader_set_error_limit(SerdReader* reader, uint64_t max_errors)
+{
+	reader->errors_left = max_errors;
+}
+
 void
 serd_reader_set_error_sink(SerdReader*   reader,
                            SerdErrorSink error_sink,
@@ -212,6 +778,8 @@ serd_reader_set_error_sink(SerdReader*   reader,
 void
 serd_reader_free(SerdReader* reader)
 {
+	free_batch(&reader->batch);  // Empty, since reading always flushes it
+	serd_reader_set_statement_id_sink(reader, NULL, 0);
 	pop_node(reader, reader->rdf_nil);
 	pop_node(reader, reader->rdf_rest);
 	pop_node(reader, reader->rdf_first);
@@ -222,6 +790,11 @@ serd_reader_free(SerdReader* reader)
 #endif
 	free(reader->stack.buf);
 	free(reader->bprefix);
+	free(reader->feed.buf);
+	clear_directives(reader);
+	free(reader->directives);
+	serd_env_free(reader->checkpoint.env);
+	serd_env_free(reader->env);
 	if (reader->free_handle) {
 		reader->free_handle(reader->handle);
 	}
@@ -248,6 +821,17 @@ serd_reader_add_blank_prefix(SerdReader*    reader,
 	}
 }
 
+SerdStatus
+serd_reader_set_blank_id_radix(SerdReader* reader, unsigned radix)
+{
+	if (radix != 10 && radix != 36 && radix != 62) {
+		return SERD_ERR_BAD_ARG;
+	}
+
+	reader->id_radix = radix;
+	return SERD_SUCCESS;
+}
+
 void
 serd_reader_set_default_graph(SerdReader*     reader,
                               const SerdNode* graph)
@@ -277,6 +861,13 @@ serd_reader_read_file(SerdReader*    reader,
 	return ret;
 }
 
+static size_t
+file_page_size(const SerdReader* reader, FILE* file)
+{
+	return reader->page_size ? reader->page_size
+	                         : serd_file_page_size(file, true);
+}
+
 static SerdStatus
 skip_bom(SerdReader* me)
 {
@@ -294,19 +885,81 @@ skip_bom(SerdReader* me)
 	return SERD_SUCCESS;
 }
 
+/** Close the source of `reader` and count the bytes that were read. */
+static SerdStatus
+serd_reader_close_source(SerdReader* reader)
+{
+	if (reader->source.prepared) {
+		reader->stats.n_bytes += (serd_byte_source_position(&reader->source) -
+		                          reader->source_start);
+	}
+
+	return serd_byte_source_close(&reader->source);
+}
+
+/** Start reading `file`, which starts with the already read `head`, decoded. */
+static SerdStatus
+serd_reader_start_decoder(SerdReader*     reader,
+                          FILE*           file,
+                          const uint8_t*  name,
+                          SerdCompression format,
+                          const uint8_t*  head,
+                          size_t          n_head,
+                          size_t          page_size)
+{
+	SerdDecoder* const decoder = serd_decoder_new(file, format, head, n_head);
+	if (!decoder) {
+		serd_byte_source_open_string(&reader->source, (const uint8_t*)"");
+		reader->source.cur.filename = name;
+		r_err(reader, SERD_ERR_UNKNOWN, "%s compressed input is not supported\n",
+		      serd_compression_name(format));
+		serd_reader_close_source(reader);
+		return SERD_ERR_UNKNOWN;
+	}
+
+	const SerdStatus st = serd_reader_start_source_stream(
+		reader, serd_decoder_read, serd_decoder_error, decoder, name, page_size);
+
+	reader->source.decoder = decoder;
+	return st;
+}
+
 SerdStatus
 serd_reader_start_stream(SerdReader*    reader,
                          FILE*          file,
                          const uint8_t* name,
                          bool           bulk)
 {
-	return serd_reader_start_source_stream(
-		reader,
-		bulk ? (SerdSource)fread : serd_file_read_byte,
-		(SerdStreamErrorFunc)ferror,
-		file,
-		name,
-		bulk ? SERD_PAGE_SIZE : 1);
+	// Read only as much as could be magic, so plain input is not held back
+	uint8_t head[SERD_MAGIC_SIZE];
+	size_t  n_head = 0;
+	int     c      = 0;
+	while (n_head < sizeof(head) &&
+	       serd_compression_incomplete(head, n_head) &&
+	       (c = getc(file)) != EOF) {
+		head[n_head++] = (uint8_t)c;
+	}
+
+	const SerdCompression format = serd_compression_detect(head, n_head);
+	if (!format && (!n_head || (n_head == 1 && ungetc(head[0], file) != EOF))) {
+		return serd_reader_start_source_stream(
+			reader,
+			bulk ? (SerdSource)fread : serd_file_read_byte,
+			(SerdStreamErrorFunc)ferror,
+			file,
+			name,
+			bulk ? file_page_size(reader, file) : 1);
+	}
+
+	// Compressed, or a head which only a decoder can put back
+	const size_t page_size =
+		!bulk ? 1
+		: format ? (reader->page_size ? reader->page_size
+		            : serd_file_page_size(file, false))
+		: file_page_size(reader, file);
+
+	return serd_reader_start_decoder(
+		reader, file, name, format, head, n_head, page_size);
 }
 
 SerdStatus
@@ -317,16 +970,35 @@ serd_reader_start_source_stream(SerdReader*         reader,
                                 const uint8_t*      name,
                                 size_t              page_size)
 {
-	return serd_byte_source_open_source(
+	const SerdStatus st = serd_byte_source_open_source(
 		&reader->source, read_func, error_func, stream, name, page_size);
+
+	if (!st && reader->read_ahead) {
+		// Read directly from the stream if a thread can not be started
+		serd_byte_source_start_read_ahead(&reader->source, reader->read_ahead);
+	}
+
+	return st;
 }
 
 static SerdStatus
 serd_reader_prepare(SerdReader* reader)
 {
-	reader->status = serd_byte_source_prepare(&reader->source);
+	SerdByteSource* const source = &reader->source;
+	reader->sink_failed = false;
+	reader->skipping    = false;
+	reader->error_ended = false;
+	memset(&reader->skip, '\0', sizeof(SkipState));
+	reader->status      = serd_byte_source_prepare(source);
+	if (reader->resume.line) {
+		source->cur = serd_reader_start_cursor(reader, source->cur.filename);
+	}
+
+	reader->source_start = serd_byte_source_position(source);
+
 	if (reader->status == SERD_SUCCESS) {
-		reader->status = skip_bom(reader);
+		// A byte order mark can only be at the start of the document
+		reader->status = source->cur.offset ? SERD_SUCCESS : skip_bom(reader);
 	} else if (reader->status == SERD_FAILURE) {
 		reader->source.eof = true;
 	} else {
@@ -335,6 +1007,19 @@ serd_reader_prepare(SerdReader* reader)
 	return reader->status;
 }
 
+/** Report a corrupt stream, which would otherwise look like the end of input. */
+static SerdStatus
+check_decoder(SerdReader* reader)
+{
+	if (reader->source.eof && reader->source.decoder &&
+	    serd_decoder_error(reader->source.decoder)) {
+		r_err(reader, SERD_ERR_UNKNOWN, "corrupt or truncated input\n");
+		return SERD_ERR_UNKNOWN;
+	}
+
+	return SERD_SUCCESS;
+}
+
 SerdStatus
 serd_reader_read_chunk(SerdReader* reader)
 {
@@ -345,13 +1030,75 @@ serd_reader_read_chunk(SerdReader* reader)
 		st = serd_byte_source_advance(&reader->source);
 	}
 
-	return st ? st : read_statement(reader) ? SERD_SUCCESS : SERD_FAILURE;
+	if (!st) {
+		if (read_statement(reader)) {
+			serd_reader_checkpoint(reader);
+		} else if (!(st = check_decoder(reader))) {
+			st = SERD_FAILURE;
+		}
+		trim_stack(reader);
+	}
+
+	const SerdStatus bst = serd_reader_flush_batch(reader);
+	return st ? st : bst;
 }
 
 SerdStatus
 serd_reader_end_stream(SerdReader* reader)
 {
-	return serd_byte_source_close(&reader->source);
+	const SerdStatus bst = serd_reader_flush_batch(reader);
+	const SerdStatus st  = serd_reader_close_source(reader);
+	return bst ? bst : st;
+}
+
+/** Read an entire document from the already opened source. */
+static SerdStatus
+serd_reader_read_opened(SerdReader* reader)
+{
+	SerdStatus st = serd_reader_prepare(reader);
+	if (!st) {
+		const bool read = read_doc(reader);
+		if (!(st = check_decoder(reader)) && !read) {
+			st = SERD_ERR_UNKNOWN;
+		}
+	}
+
+	if (st || (st = serd_reader_flush_batch(reader))) {
+		serd_reader_end_stream(reader);
+		return st;
+	}
+
+	return serd_reader_end_stream(reader);
+}
+
+/** Read a stream which is decompressed if its first bytes say so. */
+static SerdStatus
+serd_reader_read_file_stream(SerdReader*    reader,
+                             FILE*          file,
+                             const uint8_t* name)
+{
+	uint8_t               head[SERD_MAGIC_SIZE];
+	const size_t          n_head = fread(head, 1, sizeof(head), file);
+	const SerdCompression format = serd_compression_detect(head, n_head);
+	if (!format && (!n_head || !fseek(file, -(long)n_head, SEEK_CUR))) {
+		return serd_reader_read_source(
+			reader, (SerdSource)fread, (SerdStreamErrorFunc)ferror,
+			file, name, file_page_size(reader, file));
+	}
+
+	// Compressed, or a stream that can not seek back to before the head, with
+	// decoded pages, which are not limited by the size of the file
+	const size_t page_size = (reader->page_size ? reader->page_size
+	                          : serd_file_page_size(file, false));
+
+	const SerdStatus st = serd_reader_start_decoder(
+		reader, file, name, format, head, n_head, page_size);
+	if (st) {
+		serd_reader_end_stream(reader);
+		return st;
+	}
+
+	return serd_reader_read_opened(reader);
 }
 
 SerdStatus
@@ -359,9 +1106,16 @@ serd_reader_read_file_handle(SerdReader*    reader,
                              FILE*          file,
                              const uint8_t* name)
 {
-	return serd_reader_read_source(
-		reader, (SerdSource)fread, (SerdStreamErrorFunc)ferror,
-		file, name, SERD_PAGE_SIZE);
+	if (!serd_byte_source_open_mapping(&reader->source, file, name)) {
+		if (!serd_compression_detect(reader->source.read_buf,
+		                             reader->source.page_size)) {
+			return serd_reader_read_opened(reader);
+		}
+
+		serd_reader_close_source(reader);  // Decompress from the file
+	}
+
+	return serd_reader_read_file_stream(reader, file, name);
 }
 
 SerdStatus
@@ -375,15 +1129,59 @@ serd_reader_read_source(SerdReader*         reader,
 	SerdStatus st = serd_reader_start_source_stream(
 		reader, source, error, stream, name, page_size);
 
-	if (st || (st = serd_reader_prepare(reader))) {
+	if (st) {
 		serd_reader_end_stream(reader);
 		return st;
-	} else if (!read_doc(reader)) {
-		serd_reader_end_stream(reader);
-		return SERD_ERR_UNKNOWN;
 	}
 
-	return serd_reader_end_stream(reader);
+	return serd_reader_read_opened(reader);
+}
+
+/**
+   Read a part of a document in memory which starts at a statement boundary.
+
+   Errors are reported relative to `cur`, which is the position of `buf` in
+   the document.  A byte order mark is only skipped at the start of the
+   document (offset zero).  If `n_read` is given, it is set to the
+   number of bytes read, which is less than `size` if reading stopped early
+   at an error or a null byte.
+*/
+SerdStatus
+serd_reader_read_range(SerdReader*    reader,
+                       const uint8_t* buf,
+                       size_t         size,
+                       Cursor         cur,
+                       size_t*        n_read)
+{
+	uint8_t small[2] = { 0, 0 };
+	if (size < 2) {  // Too small to read in place, read as a string
+		memcpy(small, buf, size);
+		serd_byte_source_open_string(&reader->source, small);
+	} else {
+		serd_byte_source_open_range(&reader->source, buf, size, cur.filename);
+	}
+
+	reader->source.cur = cur;
+
+	SerdStatus st = SERD_SUCCESS;
+	if (!cur.offset) {
+		st = serd_reader_prepare(reader);
+	} else {
+		reader->status       = serd_byte_source_prepare(&reader->source);
+		reader->source_start = cur.offset;
+	}
+
+	if (!st) {
+		st = read_doc(reader) ? SERD_SUCCESS : SERD_ERR_UNKNOWN;
+	}
+
+	if (n_read) {
+		*n_read = (reader->source.read_buf == buf ? reader->source.read_head
+		                                          : size);
+	}
+
+	serd_reader_close_source(reader);
+	return st;
 }
 
 SerdStatus
@@ -396,7 +1194,74 @@ serd_reader_read_string(SerdReader* reader, const uint8_t* utf8)
 		st = read_doc(reader) ? SERD_SUCCESS : SERD_ERR_UNKNOWN;
 	}
 
-	serd_byte_source_close(&reader->source);
+	const SerdStatus bst = serd_reader_flush_batch(reader);
+	serd_reader_close_source(reader);
+
+	return st ? st : bst;
+}
+
+SerdCheckpoint
+serd_reader_get_checkpoint(const SerdReader* reader)
+{
+	const Checkpoint* const cp         = &reader->checkpoint;
+	SerdCheckpoint          checkpoint = { cp->cur.offset, cp->cur.line,
+	                                       cp->cur.col,    cp->next_id,
+	                                       cp->seen_genid, SERD_NODE_NULL };
+
+	// Write the environment as directives for serd_reader_resume() to read
+	SerdChunk         chunk  = { NULL, 0 };
+	SerdEnv* const    env    = serd_env_new(NULL);
+	SerdWriter* const writer = serd_writer_new(
+		SERD_TURTLE, (SerdStyle)0, env, NULL, serd_chunk_sink, &chunk);
+
+	const SerdNode* const base = serd_env_get_base_uri(cp->env, NULL);
+	if (base->buf) {
+		serd_writer_set_base_uri(writer, base);
+	}
+	serd_env_foreach(cp->env, (SerdPrefixSink)serd_writer_set_prefix, writer);
+	serd_writer_free(writer);
+	serd_env_free(env);
+
+	if (chunk.len) {
+		checkpoint.env = serd_node_from_string(
+			SERD_LITERAL, serd_chunk_sink_finish(&chunk));
+	}
+	return checkpoint;
+}
+
+static SerdStatus
+resume_base(void* handle, const SerdNode* uri)
+{
+	return serd_reader_emit_base((SerdReader*)handle, uri);
+}
+
+static SerdStatus
+resume_prefix(void* handle, const SerdNode* name, const SerdNode* uri)
+{
+	return serd_reader_emit_prefix((SerdReader*)handle, name, uri);
+}
+
+SerdStatus
+serd_reader_resume(SerdReader* reader, const SerdCheckpoint* checkpoint)
+{
+	SerdStatus st = SERD_SUCCESS;
+	if (checkpoint->env.buf) {
+		// Pass on the directives as if they were at the start of the input
+		SerdReader* const env_reader = serd_reader_new(
+			SERD_TURTLE, reader, NULL, resume_base, resume_prefix, NULL, NULL);
+
+		serd_reader_set_error_sink(
+			env_reader, reader->error_sink, reader->error_handle);
+		st = serd_reader_read_string(env_reader, checkpoint->env.buf);
+		serd_reader_free(env_reader);
+	}
+
+	const Cursor cur = { NULL, checkpoint->line, checkpoint->col,
+	                     checkpoint->offset };
 
+	reader->resume     = cur;
+	reader->next_id    = checkpoint->next_id;
+	reader->seen_genid = checkpoint->seen_genid;
+	serd_reader_set_checkpoint(reader, cur, reader->next_id, reader->seen_genid);
 	return st;
 }
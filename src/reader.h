@@ -22,6 +22,21 @@ peek_byte(SerdReader* reader)
 	return serd_byte_source_peek(&reader->source);
 }
 
+static inline const uint8_t*
+peek_bytes(SerdReader* reader)
+{
+	return reader->source.read_buf + reader->source.read_head;
+}
+
+static inline void
+skip_bytes(SerdReader* reader, size_t n)
+{
+	const SerdStatus st = serd_byte_source_skip(&reader->source, n);
+	if (st) {
+		reader->status = st;
+	}
+}
+
 static inline uint8_t
 eat_byte(SerdReader* reader)
 {
@@ -64,25 +79,46 @@ eat_string(SerdReader* reader, const char* str, unsigned n)
 	return bad;
 }
 
-static inline SerdStatus
-push_byte(SerdReader* reader, Ref ref, const uint8_t c)
+/**
+   Append `len` bytes with `n_chars` characters to the node at `ref`.
+
+   Returns a pointer to where the bytes must be written by the caller, the
+   node size and terminator are already updated.
+*/
+static inline uint8_t*
+push_reserve(SerdReader* reader, Ref ref, size_t len, size_t n_chars)
 {
 	SERD_STACK_ASSERT_TOP(reader, ref);
-	uint8_t* const  s    = serd_stack_push(&reader->stack, 1);
+	uint8_t* const  s    = serd_stack_push(&reader->stack, len);
 	SerdNode* const node = (SerdNode*)(reader->stack.buf + ref);
-	++node->n_bytes;
-	if (!(c & 0x80)) {  // Starts with 0 bit, start of new character
-		++node->n_chars;
-	}
-	*(s - 1) = c;
-	*s       = '\0';
+	node->n_bytes += len;
+	node->n_chars += n_chars;
+	s[len - 1] = '\0';
+	return s - 1;
+}
+
+static inline SerdStatus
+push_byte(SerdReader* reader, Ref ref, const uint8_t c)
+{
+	// Starts with 0 bit, start of new character
+	*push_reserve(reader, ref, 1, !(c & 0x80)) = c;
 	return SERD_SUCCESS;
 }
 
+/// Push `len` ASCII bytes, each of which is a character
+static inline void
+push_ascii(SerdReader* reader, Ref ref, const uint8_t* bytes, size_t len)
+{
+	memcpy(push_reserve(reader, ref, len, len), bytes, len);
+}
+
 static inline void
-push_bytes(SerdReader* reader, Ref ref, const uint8_t* bytes, unsigned len)
+push_bytes(SerdReader* reader, Ref ref, const uint8_t* bytes, size_t len)
 {
-	for (unsigned i = 0; i < len; ++i) {
-		push_byte(reader, ref, bytes[i]);
+	size_t n_chars = 0;
+	for (size_t i = 0; i < len; ++i) {
+		n_chars += !(bytes[i] & 0x80);
 	}
+
+	memcpy(push_reserve(reader, ref, len, n_chars), bytes, len);
 }
@@ -18,6 +18,7 @@
 #define SERD_INTERNAL_H
 
 #define _POSIX_C_SOURCE 200809L /* for posix_memalign and posix_fadvise */
+#define _DEFAULT_SOURCE         /* for madvise and MADV_HUGEPAGE */
 
 #include <assert.h>
 #include <ctype.h>
@@ -25,6 +26,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include "serd/serd.h"
 #include "serd_config.h"
@@ -33,15 +35,37 @@
 #   include <fcntl.h>
 #endif
 
+#if defined(__AVX2__)
+#   include <immintrin.h>
+#elif defined(__SSE2__)
+#   include <emmintrin.h>
+#endif
+
 #define NS_XSD "http://www.w3.org/2001/XMLSchema#"
 #define NS_RDF "http://www.w3.org/1999/02/22-rdf-syntax-ns#"
 
 #define SERD_PAGE_SIZE 4096
+#define SERD_PAGE_SIZE_MAX (1U << 20U)  ///< Maximum automatic page size
+#define SERD_DECODER_BUF_SIZE (1U << 17U)  ///< Compressed bytes read at once
+#define SERD_MAGIC_SIZE 10  ///< Bytes needed to detect compressed input
 
 #ifndef MIN
 #    define MIN(a, b) (((a) < (b)) ? (a) : (b))
 #endif
 
+/** Return a monotonic time in nanoseconds, or zero if there is no clock. */
+static inline uint64_t
+serd_time_ns(void)
+{
+#ifdef HAVE_CLOCK_GETTIME
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+#else
+	return 0;
+#endif
+}
+
 #if defined(__GNUC__)
 #    define SERD_LOG_FUNC(fmt, arg1) __attribute__((format(printf, fmt, arg1)))
 #else
@@ -79,25 +103,94 @@ serd_bufalloc(size_t size)
 #endif
 }
 
+/**
+   Return a good size for pages to read from or write to `file`.
+
+   This is a multiple of the preferred block size of the file, limited to the
+   size of the file if `input` is true.
+*/
+size_t
+serd_file_page_size(FILE* file, bool input);
+
+/* Decompression */
+
+typedef enum {
+	SERD_COMPRESSION_NONE,   ///< Not compressed
+	SERD_COMPRESSION_GZIP,   ///< Gzip (RFC 1952), including bgzip
+	SERD_COMPRESSION_BZIP2,  ///< Bzip2
+	SERD_COMPRESSION_ZSTD    ///< Zstandard (RFC 8878)
+} SerdCompression;
+
+typedef struct SerdDecoderImpl SerdDecoder;
+
+/** Return the compression format of input which starts with `buf`. */
+SerdCompression
+serd_compression_detect(const uint8_t* buf, size_t size);
+
+/**
+   Return true iff `buf` is the start of some compressed input's magic bytes.
+
+   More bytes are needed to detect the format of such input.
+*/
+bool
+serd_compression_incomplete(const uint8_t* buf, size_t size);
+
+/** Return the name of a compression format for messages. */
+const char*
+serd_compression_name(SerdCompression format);
+
+/**
+   Create a decoder for `file`, which starts with the already read `head`.
+
+   Returns NULL if the format is not supported by this build.  With
+   SERD_COMPRESSION_NONE, `head` is returned before reading from `file`
+   directly, which allows detection on streams which can not seek.
+*/
+SerdDecoder*
+serd_decoder_new(FILE*           file,
+                 SerdCompression format,
+                 const uint8_t*  head,
+                 size_t          head_size);
+
+/** Read decoded bytes, a SerdSource which always fills `buf` if it can. */
+size_t
+serd_decoder_read(void* buf, size_t size, size_t nmemb, void* stream);
+
+/** Return non-zero if reading or decoding failed, a SerdStreamErrorFunc. */
+int
+serd_decoder_error(void* stream);
+
+void
+serd_decoder_free(SerdDecoder* decoder);
+
 /* Byte source */
 
 typedef struct {
 	const uint8_t* filename;
 	unsigned       line;
 	unsigned       col;
+	uint64_t       offset;  ///< Number of bytes before this position
 } Cursor;
 
+typedef struct SerdReadAheadImpl SerdReadAhead;
+
 typedef struct {
 	SerdSource          read_func;    ///< Read function (e.g. fread)
 	SerdStreamErrorFunc error_func;   ///< Error function (e.g. ferror)
 	void*               stream;       ///< Stream (e.g. FILE)
-	size_t              page_size;    ///< Number of bytes to read at a time
-	Cursor              cur;          ///< Cursor for error reporting
+	size_t              page_size;    ///< Bytes to read at a time, or in string
+	void*               map;          ///< Mapping of the file to unmap, or NULL
+	size_t              map_size;     ///< Size of `map`
+	Cursor              cur;          ///< Cursor at cur_head for error reporting
+	size_t              cur_head;     ///< Offset into read_buf of cur
 	uint8_t*            file_buf;     ///< Buffer iff reading pages from a file
 	const uint8_t*      read_buf;     ///< Pointer to file_buf or read_byte
 	size_t              read_head;    ///< Offset into read_buf
 	uint8_t             read_byte;    ///< 1-byte 'buffer' used when not paging
+	SerdReadAhead*      ahead;        ///< Thread reading pages, or NULL
+	SerdDecoder*        decoder;      ///< Decoder of `stream`, or NULL
 	bool                from_stream;  ///< True iff reading from `stream`
+	bool                mapped;       ///< True iff read_buf is all in memory
 	bool                prepared;     ///< True iff prepared for reading
 	bool                eof;          ///< True iff end of file reached
 } SerdByteSource;
@@ -110,6 +203,17 @@ serd_byte_source_open_file(SerdByteSource* source,
 SerdStatus
 serd_byte_source_open_string(SerdByteSource* source, const uint8_t* utf8);
 
+SerdStatus
+serd_byte_source_open_range(SerdByteSource* source,
+                            const uint8_t*  buf,
+                            size_t          size,
+                            const uint8_t*  name);
+
+SerdStatus
+serd_byte_source_open_mapping(SerdByteSource* source,
+                              FILE*           file,
+                              const uint8_t*  name);
+
 SerdStatus
 serd_byte_source_open_source(SerdByteSource*     source,
                              SerdSource          read_func,
@@ -118,6 +222,9 @@ serd_byte_source_open_source(SerdByteSource*     source,
                              const uint8_t*      name,
                              size_t              page_size);
 
+SerdStatus
+serd_byte_source_start_read_ahead(SerdByteSource* source, unsigned n_pages);
+
 SerdStatus
 serd_byte_source_close(SerdByteSource* source);
 
@@ -127,6 +234,45 @@ serd_byte_source_prepare(SerdByteSource* source);
 SerdStatus
 serd_byte_source_page(SerdByteSource* source);
 
+void
+serd_byte_source_update_cursor(SerdByteSource* source);
+
+/**
+   Lexical state of input skipped after an error.
+
+   Only the tokens which may contain a terminator are known: IRIs, strings,
+   and comments, which end with `close`, or three of it for a long string.
+   The depth is counted by the parser until the error, then by skipping.
+*/
+typedef struct {
+	unsigned depth;        ///< Number of brackets and braces open
+	uint8_t  close;        ///< Byte which ends the current token, or zero
+	uint8_t  n_quotes;     ///< Number of quotes in a row at a string edge
+	uint8_t  last;         ///< Last non-blank byte outside tokens on the line
+	bool     long_string;  ///< True iff in a long string
+	bool     escaped;      ///< True iff the next byte is escaped
+} SkipState;
+
+/**
+   Advance to the next `byte` in the input, or the end, and return it or zero.
+
+   The input is searched a page at a time where it is buffered.  If `skip` is
+   not null, it is updated with the skipped bytes.
+*/
+uint8_t
+serd_byte_source_skip_to(SerdByteSource* source, uint8_t byte, SkipState* skip);
+
+/** Return the offset of the current byte of `source` in the input. */
+static inline uint64_t
+serd_byte_source_position(const SerdByteSource* source)
+{
+	if (source->from_stream && source->page_size <= 1) {
+		return source->cur.offset;  // Updated by serd_byte_source_advance()
+	}
+
+	return source->cur.offset + (source->read_head - source->cur_head);
+}
+
 static inline uint8_t
 serd_byte_source_peek(SerdByteSource* source)
 {
@@ -134,17 +280,54 @@ serd_byte_source_peek(SerdByteSource* source)
 	return source->read_buf[source->read_head];
 }
 
-static inline SerdStatus
-serd_byte_source_advance(SerdByteSource* source)
+/**
+   Return the number of bytes at the read head which stay valid in memory
+   until the source is closed, or zero if the source is paged.
+*/
+static inline size_t
+serd_byte_source_stable_size(const SerdByteSource* source)
 {
-	SerdStatus st = SERD_SUCCESS;
+	return ((source->from_stream && !source->mapped)
+	        ? 0
+	        : source->page_size - source->read_head);
+}
+
+/**
+   Return the number of bytes at the read head which are in memory.
+
+   Note that the available bytes may contain a null terminator, followed by
+   stale data which must not be read.
+*/
+static inline size_t
+serd_byte_source_available(const SerdByteSource* source)
+{
+	return ((source->from_stream && source->page_size <= 1)
+	        ? 0
+	        : source->page_size - source->read_head);
+}
+
+/**
+   Advance past `n` bytes at once.
 
-	switch (serd_byte_source_peek(source)) {
-	case '\0': break;
-	case '\n': ++source->cur.line; source->cur.col = 0; break;
-	default:   ++source->cur.col;
+   All of the bytes must be in the current page, and must not contain a null.
+*/
+static inline SerdStatus
+serd_byte_source_skip(SerdByteSource* source, size_t n)
+{
+	source->read_head += n;
+	if (source->from_stream && source->read_head == source->page_size) {
+		return serd_byte_source_page(source);
 	}
 
+	return SERD_SUCCESS;
+}
+
+static inline SerdStatus
+serd_byte_source_advance(SerdByteSource* source)
+{
+	SerdStatus    st = SERD_SUCCESS;
+	const uint8_t c  = serd_byte_source_peek(source);
+
 	if (source->from_stream) {
 		source->eof = false;
 		if (source->page_size > 1) {
@@ -152,13 +335,24 @@ serd_byte_source_advance(SerdByteSource* source)
 				st = serd_byte_source_page(source);
 			}
 		} else {
+			// Bytes are not kept, so the cursor must be updated as we go
+			++source->cur.offset;
+			switch (c) {
+			case '\0': break;
+			case '\n': ++source->cur.line; source->cur.col = 0; break;
+			default:   ++source->cur.col;
+			}
+
 			if (!source->read_func(&source->read_byte, 1, 1, source->stream)) {
+				source->read_byte = '\0';  // Unlike getc(), fread() leaves it
 				st = source->error_func(source->stream) ? SERD_ERR_UNKNOWN
 				                                        : SERD_FAILURE;
 			}
 		}
-	} else if (!source->eof) {
+	} else if (c) {
 		++source->read_head; // Move to next character in string
+	} else {
+		source->eof = true; // Never move past the terminator
 	}
 
 	return source->eof ? SERD_FAILURE : st;
@@ -171,11 +365,22 @@ typedef struct {
 	uint8_t* buf;       ///< Stack memory
 	size_t   buf_size;  ///< Allocated size of buf (>= size)
 	size_t   size;      ///< Conceptual size of stack in buf
+	size_t   peak;      ///< Largest size as of the last pop
+	double   growth;    ///< Factor to grow buf_size by when full
 } SerdStack;
 
+/** Default factor to grow stacks by. */
+#define SERD_STACK_GROWTH 1.5
+
 /** An offset to start the stack at. Note 0 is reserved for NULL. */
 #define SERD_STACK_BOTTOM sizeof(void*)
 
+/**
+   A bit in the pad count preceding an aligned allocation which is free for
+   use by the owner, since alignments are always less than 128 bytes.
+*/
+#define SERD_STACK_TAG 0x80
+
 static inline SerdStack
 serd_stack_new(size_t size)
 {
@@ -183,6 +388,8 @@ serd_stack_new(size_t size)
 	stack.buf       = (uint8_t*)calloc(size, 1);
 	stack.buf_size  = size;
 	stack.size      = SERD_STACK_BOTTOM;
+	stack.peak      = SERD_STACK_BOTTOM;
+	stack.growth    = SERD_STACK_GROWTH;
 	return stack;
 }
 
@@ -206,8 +413,9 @@ serd_stack_push(SerdStack* stack, size_t n_bytes)
 {
 	const size_t new_size = stack->size + n_bytes;
 	if (stack->buf_size < new_size) {
-		stack->buf_size += (stack->buf_size >> 1); // *= 1.5
-		stack->buf = (uint8_t*)realloc(stack->buf, stack->buf_size);
+		const size_t grown = (size_t)((double)stack->buf_size * stack->growth);
+		stack->buf_size = grown > new_size ? grown : new_size;
+		stack->buf      = (uint8_t*)realloc(stack->buf, stack->buf_size);
 	}
 	uint8_t* const ret = (stack->buf + stack->size);
 	stack->size = new_size;
@@ -218,9 +426,32 @@ static inline void
 serd_stack_pop(SerdStack* stack, size_t n_bytes)
 {
 	assert(stack->size >= n_bytes);
+	if (stack->size > stack->peak) {  // Cheaper to track here than in push
+		stack->peak = stack->size;
+	}
 	stack->size -= n_bytes;
 }
 
+/** Return the largest size the stack has reached. */
+static inline size_t
+serd_stack_peak(const SerdStack* stack)
+{
+	return stack->size > stack->peak ? stack->size : stack->peak;
+}
+
+/** Reallocate to `buf_size` bytes, if the contents fit. */
+static inline void
+serd_stack_resize(SerdStack* stack, size_t buf_size)
+{
+	if (buf_size >= stack->size && buf_size != stack->buf_size) {
+		uint8_t* const buf = (uint8_t*)realloc(stack->buf, buf_size);
+		if (buf) {
+			stack->buf      = buf;
+			stack->buf_size = buf_size;
+		}
+	}
+}
+
 static inline void*
 serd_stack_push_aligned(SerdStack* stack, size_t n_bytes, size_t align)
 {
@@ -247,22 +478,87 @@ serd_stack_pop_aligned(SerdStack* stack, size_t n_bytes)
 	serd_stack_pop(stack, n_bytes);
 
 	// Get amount of padding from top of stack
-	const uint8_t pad = stack->buf[stack->size - 1];
+	const uint8_t pad = stack->buf[stack->size - 1] & ~SERD_STACK_TAG;
 
 	// Pop padding and pad count
 	serd_stack_pop(stack, pad + 1);
 }
 
+/* Asynchronous I/O */
+
+typedef struct SerdUringImpl SerdUring;
+
+/**
+   Create an io_uring for reading or writing `fd` with `n_bufs` buffers.
+
+   Returns NULL if io_uring is not supported or not permitted, in which case
+   the caller should fall back to synchronous I/O.
+*/
+SerdUring*
+serd_uring_new(int fd, unsigned n_bufs, size_t buf_size);
+
+/** Return the buffer at index `i`. */
+uint8_t*
+serd_uring_buf(const SerdUring* ring, unsigned i);
+
+/** Submit a read or write of `len` bytes at `offset` to or from buffer `i`. */
+void
+serd_uring_submit(SerdUring* ring,
+                  unsigned   i,
+                  bool       write,
+                  size_t     len,
+                  int64_t    offset);
+
+/**
+   Wait for the last operation on buffer `i` to complete.
+
+   Short transfers are completed synchronously, so this returns the requested
+   length except at the end of a file, or a negative error code.
+*/
+int64_t
+serd_uring_wait(SerdUring* ring, unsigned i);
+
+/** Wait for all operations to complete and free `ring`. */
+void
+serd_uring_free(SerdUring* ring);
+
 /* Byte Sink */
 
+typedef struct SerdWriteBehindImpl SerdWriteBehind;
+
 typedef struct SerdByteSinkImpl {
-	SerdSink sink;
-	void*    stream;
-	uint8_t* buf;
-	size_t   size;
-	size_t   block_size;
+	SerdSink         sink;
+	void*            stream;
+	uint8_t*         buf;
+	size_t           size;
+	size_t           block_size;
+	SerdWriteBehind* behind;
+	uint64_t         sink_ns;  ///< Time spent flushing if timed
+	bool             timed;    ///< True iff time spent flushing is measured
 } SerdByteSink;
 
+/**
+   Write blocks to the file of a byte sink asynchronously.
+
+   Full blocks are submitted to an io_uring with `n_blocks` buffers, and
+   filling continues in the next buffer.  This fails if the sink is not a
+   buffered serd_file_sink(), or if io_uring is unavailable.
+*/
+SerdStatus
+serd_byte_sink_start_write_behind(SerdByteSink* bsink, unsigned n_blocks);
+
+/** Submit the current block and continue in the next one. */
+void
+serd_write_behind_flush(SerdByteSink* bsink);
+
+/** Wait until all submitted blocks are written. */
+void
+serd_write_behind_sync(SerdByteSink* bsink);
+
+/** Wait until all submitted blocks are written and stop writing behind. */
+void
+serd_write_behind_free(SerdByteSink* bsink);
+
 static inline SerdByteSink
 serd_byte_sink_new(SerdSink sink, void* stream, size_t block_size)
 {
@@ -271,6 +567,9 @@ serd_byte_sink_new(SerdSink sink, void* stream, size_t block_size)
 	bsink.stream     = stream;
 	bsink.size       = 0;
 	bsink.block_size = block_size;
+	bsink.behind     = NULL;
+	bsink.sink_ns    = 0;
+	bsink.timed      = false;
 	bsink.buf        = ((block_size > 1)
 	                    ? (uint8_t*)serd_bufalloc(block_size)
 	                    : NULL);
@@ -281,8 +580,16 @@ static inline void
 serd_byte_sink_flush(SerdByteSink* bsink)
 {
 	if (bsink->block_size > 1 && bsink->size > 0) {
-		bsink->sink(bsink->buf, bsink->size, bsink->stream);
-		bsink->size = 0;
+		const uint64_t t0 = bsink->timed ? serd_time_ns() : 0;
+		if (bsink->behind) {
+			serd_write_behind_flush(bsink);
+		} else {
+			bsink->sink(bsink->buf, bsink->size, bsink->stream);
+			bsink->size = 0;
+		}
+		if (bsink->timed) {
+			bsink->sink_ns += serd_time_ns() - t0;
+		}
 	}
 }
 
@@ -290,8 +597,12 @@ static inline void
 serd_byte_sink_free(SerdByteSink* bsink)
 {
 	serd_byte_sink_flush(bsink);
-	free(bsink->buf);
-	bsink->buf = NULL;
+	if (bsink->behind) {
+		serd_write_behind_free(bsink);
+	} else {
+		free(bsink->buf);
+		bsink->buf = NULL;
+	}
 }
 
 static inline size_t
@@ -300,7 +611,14 @@ serd_byte_sink_write(const void* buf, size_t len, SerdByteSink* bsink)
 	if (len == 0) {
 		return 0;
 	} else if (bsink->block_size == 1) {
-		return bsink->sink(buf, len, bsink->stream);
+		if (!bsink->timed) {
+			return bsink->sink(buf, len, bsink->stream);
+		}
+
+		const uint64_t t0 = serd_time_ns();
+		const size_t   n  = bsink->sink(buf, len, bsink->stream);
+		bsink->sink_ns += serd_time_ns() - t0;
+		return n;
 	}
 
 	const size_t orig_len = len;
@@ -316,8 +634,7 @@ serd_byte_sink_write(const void* buf, size_t len, SerdByteSink* bsink)
 
 		// Flush page if buffer is full
 		if (bsink->size == bsink->block_size) {
-			bsink->sink(bsink->buf, bsink->block_size, bsink->stream);
-			bsink->size = 0;
+			serd_byte_sink_flush(bsink);
 		}
 	}
 	return orig_len;
@@ -442,6 +759,418 @@ parse_utf8_char(const uint8_t* utf8, size_t* size)
 	}
 }
 
+/* Scanning utilities */
+
+#if defined(__SSE2__) && defined(__GNUC__)
+#    define SERD_SCAN_SIMD 1
+#endif
+
+/// Return true iff `c` ends a run of plain characters in a string literal
+static inline bool
+is_string_special(const uint8_t c)
+{
+	switch (c) {
+	case '\0': case '\n': case '\r': case '"': case '\'': case '\\':
+		return true;
+	default:
+		return c & 0x80;
+	}
+}
+
+#ifdef SERD_SCAN_SIMD
+/// Return a mask of the ASCII bytes in `v` that end a run in a string
+static inline __m128i
+string_specials16(const __m128i v)
+{
+	return _mm_or_si128(
+		_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(0)),
+		                          _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))),
+		             _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')),
+		                          _mm_cmpeq_epi8(v, _mm_set1_epi8('"')))),
+		_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\'')),
+		             _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))));
+}
+
+static inline unsigned
+scan_string_mask16(const __m128i v)
+{
+	// High bit set for non-ASCII
+	return (unsigned)_mm_movemask_epi8(_mm_or_si128(string_specials16(v), v));
+}
+#endif
+
+#if defined(SERD_SCAN_SIMD) && defined(__AVX2__)
+static inline unsigned
+scan_string_mask32(const __m256i v)
+{
+	const __m256i m = _mm256_or_si256(
+		_mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(0)),
+			                _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))),
+			_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')),
+			                _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')))),
+		_mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\'')),
+			                _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))),
+			v));  // High bit set for non-ASCII
+
+	return (unsigned)_mm256_movemask_epi8(m);
+}
+#endif
+
+/**
+   Return the length of the run of plain ASCII at the start of `str`.
+
+   The run ends before the first null, line end, quote, backslash, or non-ASCII
+   byte, or after `len` bytes, so it can be copied into a string literal as-is.
+*/
+static inline size_t
+serd_scan_string(const uint8_t* str, const size_t len)
+{
+	size_t i = 0;
+#ifdef SERD_SCAN_SIMD
+#    ifdef __AVX2__
+	for (; i + 32 <= len; i += 32) {
+		const __m256i  v    = _mm256_loadu_si256((const __m256i*)(str + i));
+		const unsigned mask = scan_string_mask32(v);
+		if (mask) {
+			return i + (size_t)__builtin_ctz(mask);
+		}
+	}
+#    endif
+	for (; i + 16 <= len; i += 16) {
+		const __m128i  v    = _mm_loadu_si128((const __m128i*)(str + i));
+		const unsigned mask = scan_string_mask16(v);
+		if (mask) {
+			return i + (size_t)__builtin_ctz(mask);
+		}
+	}
+#endif
+	while (i < len && !is_string_special(str[i])) {
+		++i;
+	}
+	return i;
+}
+
+/// Return true iff `c` ends a run of plain characters in an IRI reference
+static inline bool
+is_iri_special(const uint8_t c)
+{
+	switch (c) {
+	case '"': case '<': case '>': case '\\':
+	case '^': case '`': case '{': case '|': case '}':
+		return true;
+	default:
+		return c <= 0x20 || (c & 0x80);
+	}
+}
+
+#ifdef SERD_SCAN_SIMD
+/// Return a mask of the ASCII bytes in `v` that end a run in an IRI
+static inline __m128i
+iri_specials16(const __m128i v)
+{
+	// Signed comparisons, so exclude non-ASCII from control characters
+	const __m128i low = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(-1)),
+	                                  _mm_cmplt_epi8(v, _mm_set1_epi8(0x21)));
+
+	return _mm_or_si128(
+		_mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')),
+			             _mm_cmpeq_epi8(v, _mm_set1_epi8('<'))),
+			_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('>')),
+			             _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')))),
+		_mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('^')),
+			             _mm_cmpeq_epi8(v, _mm_set1_epi8('`'))),
+			_mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('{')),
+				             _mm_cmpeq_epi8(v, _mm_set1_epi8('|'))),
+				_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('}')), low))));
+}
+
+static inline unsigned
+scan_iri_mask16(const __m128i v)
+{
+	// High bit set for non-ASCII
+	return (unsigned)_mm_movemask_epi8(_mm_or_si128(iri_specials16(v), v));
+}
+#endif
+
+#if defined(SERD_SCAN_SIMD) && defined(__AVX2__)
+static inline unsigned
+scan_iri_mask32(const __m256i v)
+{
+	// Signed comparison, so also true for non-ASCII
+	const __m256i low = _mm256_cmpgt_epi8(_mm256_set1_epi8(0x21), v);
+
+	const __m256i m = _mm256_or_si256(
+		_mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')),
+			                _mm256_cmpeq_epi8(v, _mm256_set1_epi8('<'))),
+			_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('>')),
+			                _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')))),
+		_mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('^')),
+			                _mm256_cmpeq_epi8(v, _mm256_set1_epi8('`'))),
+			_mm256_or_si256(
+				_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('{')),
+				                _mm256_cmpeq_epi8(v, _mm256_set1_epi8('|'))),
+				_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('}')),
+				                low))));
+
+	return (unsigned)_mm256_movemask_epi8(m);
+}
+#endif
+
+/// Return the length of the run of Turtle whitespace at the start of `str`
+static inline size_t
+serd_scan_ws(const uint8_t* str, const size_t len)
+{
+	size_t i = 0;
+#ifdef SERD_SCAN_SIMD
+	for (; i + 16 <= len; i += 16) {
+		const __m128i v = _mm_loadu_si128((const __m128i*)(str + i));
+		const __m128i m = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(0x9)),
+			             _mm_cmpeq_epi8(v, _mm_set1_epi8(0xA))),
+			_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(0xD)),
+			             _mm_cmpeq_epi8(v, _mm_set1_epi8(0x20))));
+
+		const unsigned mask = ~(unsigned)_mm_movemask_epi8(m) & 0xFFFF;
+		if (mask) {
+			return i + (size_t)__builtin_ctz(mask);
+		}
+	}
+#endif
+	for (; i < len; ++i) {
+		switch (str[i]) {
+		case 0x9: case 0xA: case 0xD: case 0x20:
+			continue;
+		}
+		break;
+	}
+	return i;
+}
+
+/// Return the length of the comment text at the start of `str`
+static inline size_t
+serd_scan_comment(const uint8_t* str, const size_t len)
+{
+	const uint8_t* end = (const uint8_t*)memchr(str, '\n', len);
+	size_t         n   = end ? (size_t)(end - str) : len;
+	if ((end = (const uint8_t*)memchr(str, '\r', n))) {
+		n = (size_t)(end - str);
+	}
+	if ((end = (const uint8_t*)memchr(str, '\0', n))) {
+		n = (size_t)(end - str);
+	}
+	return n;
+}
+
+/**
+   Return the length of the run of plain ASCII at the start of `str`.
+
+   The run ends before the first control character, space, non-ASCII byte,
+   backslash, `>', or character that is forbidden in an IRI reference, or after
+   `len` bytes, so it can be copied into an IRI as-is.
+*/
+static inline size_t
+serd_scan_iri(const uint8_t* str, const size_t len)
+{
+	size_t i = 0;
+#ifdef SERD_SCAN_SIMD
+#    ifdef __AVX2__
+	for (; i + 32 <= len; i += 32) {
+		const __m256i  v    = _mm256_loadu_si256((const __m256i*)(str + i));
+		const unsigned mask = scan_iri_mask32(v);
+		if (mask) {
+			return i + (size_t)__builtin_ctz(mask);
+		}
+	}
+#    endif
+	for (; i + 16 <= len; i += 16) {
+		const __m128i  v    = _mm_loadu_si128((const __m128i*)(str + i));
+		const unsigned mask = scan_iri_mask16(v);
+		if (mask) {
+			return i + (size_t)__builtin_ctz(mask);
+		}
+	}
+#endif
+	while (i < len && !is_iri_special(str[i])) {
+		++i;
+	}
+	return i;
+}
+
+/**
+   Return the size of the valid UTF-8 character at the start of `str`.
+
+   This is strict (RFC 3629), so returns zero for overlong encodings,
+   surrogates, code points past U+10FFFF, and incomplete characters.
+*/
+static inline size_t
+utf8_valid_size(const uint8_t* str, const size_t len)
+{
+	const uint8_t c    = str[0];
+	uint8_t       min  = 0x80;
+	uint8_t       max  = 0xBF;
+	size_t        size = 0;
+	if (c < 0x80) {
+		return 1;
+	} else if (c < 0xC2) {
+		return 0;
+	} else if (c < 0xE0) {
+		size = 2;
+	} else if (c < 0xF0) {
+		size = 3;
+		min  = (c == 0xE0) ? 0xA0 : 0x80;
+		max  = (c == 0xED) ? 0x9F : 0xBF;
+	} else if (c < 0xF5) {
+		size = 4;
+		min  = (c == 0xF0) ? 0x90 : 0x80;
+		max  = (c == 0xF4) ? 0x8F : 0xBF;
+	} else {
+		return 0;
+	}
+
+	if (size > len || str[1] < min || str[1] > max) {
+		return 0;
+	}
+
+	for (size_t i = 2; i < size; ++i) {
+		if ((str[i] & 0xC0) != 0x80) {
+			return 0;
+		}
+	}
+
+	return size;
+}
+
+#ifdef SERD_SCAN_SIMD
+/// Return the bytes of `v` shifted later by `n`, after the end of `prev`
+#    define SERD_SHIFT_IN(prev, v, n) \
+	_mm_or_si128(_mm_slli_si128((v), (n)), _mm_srli_si128((prev), 16 - (n)))
+
+/// Return a mask of the bytes in `v` that are signed `min` to `max`
+static inline __m128i
+in_range16(const __m128i v, const char min, const char max)
+{
+	return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8((char)(min - 1))),
+	                     _mm_cmplt_epi8(v, _mm_set1_epi8((char)(max + 1))));
+}
+
+/**
+   Return a mask of the bytes in `v` that are not part of valid UTF-8.
+
+   This checks UTF-8 with comparisons, in the style of simdutf but without
+   lookup tables, which need SSSE3.  Bytes are classified as signed values,
+   where 0x80 is -128, and the continuation bytes each lead byte requires are
+   found by shifting lead bytes from `v` and the previous block `prev`.
+   Characters that continue past the end of `v` are not checked.
+*/
+static inline __m128i
+utf8_errors16(const __m128i prev, const __m128i v)
+{
+	const __m128i v1 = SERD_SHIFT_IN(prev, v, 1);  // Bytes 1 before
+	const __m128i v2 = SERD_SHIFT_IN(prev, v, 2);  // Bytes 2 before
+	const __m128i v3 = SERD_SHIFT_IN(prev, v, 3);  // Bytes 3 before
+
+	// Classify bytes: ASCII, continuation, or lead byte C2..F4
+	const __m128i ascii = _mm_cmpgt_epi8(v, _mm_set1_epi8(-1));
+	const __m128i cont  = _mm_cmplt_epi8(v, _mm_set1_epi8(-64));
+	const __m128i lead  = in_range16(v, -62, -12);
+
+	// Continuation bytes required after lead bytes up to 3 bytes before
+	const __m128i need = _mm_or_si128(
+		_mm_or_si128(in_range16(v1, -62, -12), in_range16(v2, -32, -12)),
+		in_range16(v3, -16, -12));
+
+	// Second bytes out of range for overlong, surrogate, or large code points
+	const __m128i second = _mm_or_si128(
+		_mm_or_si128(
+			_mm_and_si128(_mm_cmpeq_epi8(v1, _mm_set1_epi8(-32)),    // E0
+			              _mm_cmplt_epi8(v, _mm_set1_epi8(-96))),    // < A0
+			_mm_and_si128(_mm_cmpeq_epi8(v1, _mm_set1_epi8(-19)),    // ED
+			              _mm_cmpgt_epi8(v, _mm_set1_epi8(-97)))),   // > 9F
+		_mm_or_si128(
+			_mm_and_si128(_mm_cmpeq_epi8(v1, _mm_set1_epi8(-16)),    // F0
+			              _mm_cmplt_epi8(v, _mm_set1_epi8(-112))),   // < 90
+			_mm_and_si128(_mm_cmpeq_epi8(v1, _mm_set1_epi8(-12)),    // F4
+			              _mm_cmpgt_epi8(v, _mm_set1_epi8(-113)))));  // > 8F
+
+	// Invalid bytes (C0, C1, and F5..FF), or continuations that are wrong
+	const __m128i invalid = _mm_andnot_si128(
+		_mm_or_si128(_mm_or_si128(ascii, cont), lead), _mm_set1_epi8(-1));
+
+	return _mm_or_si128(_mm_or_si128(invalid, _mm_xor_si128(need, cont)),
+	                    second);
+}
+#endif
+
+/**
+   Return the length of the run of plain valid UTF-8 at the start of `str`.
+
+   This is like serd_scan_string(), or serd_scan_iri() if `iri` is true,
+   except the run also includes non-ASCII characters that are valid UTF-8.
+   The run ends before the first special ASCII byte, or invalid or incomplete
+   character, and the number of ASCII characters in it is added to `n_ascii`.
+*/
+static inline size_t
+serd_scan_utf8(const uint8_t* str,
+               const size_t   len,
+               const bool     iri,
+               size_t*        n_ascii)
+{
+	size_t i      = 0;
+	size_t n_utf8 = 0;
+#ifdef SERD_SCAN_SIMD
+	__m128i prev = _mm_setzero_si128();
+	for (; i + 16 <= len; i += 16) {
+		const __m128i v    = _mm_loadu_si128((const __m128i*)(str + i));
+		const __m128i bad  = _mm_or_si128(
+			iri ? iri_specials16(v) : string_specials16(v),
+			utf8_errors16(prev, v));
+		if (_mm_movemask_epi8(bad)) {
+			break;
+		}
+
+		n_utf8 += (size_t)__builtin_popcount(
+			(unsigned)_mm_movemask_epi8(v));
+		prev = v;
+	}
+
+	// Check the last character, which may be incomplete, again below
+	size_t start = i;
+	while (start > 0 && i - start < 3 && (str[start - 1] & 0xC0) == 0x80) {
+		--start;
+	}
+	if (start > 0 && str[start - 1] >= 0xC0) {
+		n_utf8 -= i - start + 1;
+		i = start - 1;
+	}
+#endif
+	while (i < len) {
+		if (!(str[i] & 0x80)) {
+			if (iri ? is_iri_special(str[i]) : is_string_special(str[i])) {
+				break;
+			}
+			++i;
+			continue;
+		}
+
+		const size_t size = utf8_valid_size(str + i, len - i);
+		if (!size) {
+			break;
+		}
+		i      += size;
+		n_utf8 += size;
+	}
+
+	*n_ascii += i - n_utf8;
+	return i;
+}
+
 /* URI utilities */
 
 static inline bool
@@ -567,6 +1296,93 @@ typedef struct {
 	SerdStatementFlags* flags;
 } ReadContext;
 
+/// A statement in a batch, with nodes as offsets into the batch arena
+typedef struct {
+	SerdStatementFlags flags;     ///< Statement flags
+	size_t             nodes[6];  ///< Node offsets, or zero for NULL
+} BatchedStatement;
+
+/// Statements collected for a SerdStatementBatchSink
+typedef struct {
+	SerdStatementBatchSink sink;          ///< Sink for batches, or NULL
+	size_t                 size;          ///< Maximum number of statements
+	size_t                 n_statements;  ///< Number of statements in batch
+	BatchedStatement*      statements;    ///< Statements in batch
+	SerdStatement*         out;           ///< Statements passed to sink
+	SerdStack              arena;         ///< Copies of nodes
+} StatementBatch;
+
+/// A slot in a TermGeneration, which is empty if `entry` is zero
+typedef struct {
+	uint64_t hash;   ///< Hash of node
+	size_t   entry;  ///< Offset of TermEntry in arena plus one, or zero
+} TermSlot;
+
+/// An interned node in the arena of a TermGeneration, followed by its string
+typedef struct {
+	SerdTermId id;       ///< ID of node
+	size_t     n_bytes;  ///< Length of string
+	SerdType   type;     ///< Type of node
+} TermEntry;
+
+/// A generation of interned nodes, an open hash table with a string arena
+typedef struct {
+	TermSlot* slots;      ///< Hash table, with a power of two slots
+	size_t    n_slots;    ///< Number of slots
+	size_t    n_terms;    ///< Number of entries
+	size_t    n_live;     ///< Number of entries not copied to a newer one
+	uint8_t*  arena;      ///< Entries and their strings
+	size_t    size;       ///< Bytes used in arena
+	size_t    capacity;   ///< Bytes allocated for arena
+} TermGeneration;
+
+/// Interned nodes for a SerdStatementIdSink, see terms.c
+typedef struct {
+	SerdStatementIdSink sink;     ///< Sink for statements, or NULL
+	TermGeneration      gens[2];  ///< Newer, then older generation
+	SerdTermId          next_id;  ///< ID of next new node
+	const TermEntry*    last[6];  ///< Entry of each node of last statement
+} TermTable;
+
+/// Lexical state of input fed to a reader, between reads
+typedef enum {
+	FEED_TOP,          ///< Outside any token that may contain a terminator
+	FEED_END,          ///< Between the end of a statement and the next
+	FEED_IRI,          ///< In an IRI
+	FEED_STRING,       ///< In a short string
+	FEED_LONG_STRING,  ///< In a long string
+	FEED_COMMENT,      ///< In a comment
+	FEED_END_COMMENT   ///< In a comment after the end of a statement
+} FeedState;
+
+/// Input fed to a reader which does not yet end with a complete statement
+typedef struct {
+	uint8_t*   buf;     ///< Bytes after the last complete statement
+	size_t     size;    ///< Allocated size of buf
+	size_t     len;     ///< Number of bytes in buf
+	size_t     scanned; ///< Number of bytes in buf scanned for statements
+	Cursor     cur;     ///< Position of buf in the input, line 0 if unstarted
+	FeedState  state;   ///< Lexical state after the scanned bytes
+	uint8_t    quote;   ///< Quote character of string, if in one
+	bool       newline; ///< True iff a newline follows the end of a statement
+	unsigned   depth;   ///< Depth of graphs after the scanned bytes
+	SerdStatus status;  ///< Error which stopped reading, if any
+} Feed;
+
+/// Position after the last complete statement, see serd_reader_get_checkpoint()
+typedef struct {
+	Cursor   cur;         ///< Position in input
+	unsigned next_id;     ///< Number of the next generated blank ID
+	bool     seen_genid;  ///< True iff a `b' ID was read
+	SerdEnv* env;         ///< Base URI and prefixes at position
+} Checkpoint;
+
+/// A base URI (with a null name) or prefix read since the last checkpoint
+typedef struct {
+	SerdNode name;
+	SerdNode uri;
+} Directive;
+
 struct SerdReaderImpl {
 	void*             handle;
 	void              (*free_handle)(void* ptr);
@@ -574,6 +1390,25 @@ struct SerdReaderImpl {
 	SerdPrefixSink    prefix_sink;
 	SerdStatementSink statement_sink;
 	SerdEndSink       end_sink;
+	SerdEndSink       undefined_sink; ///< Takes undefined prefixed names, or null
+	StatementBatch    batch;       ///< Statements for the batch sink
+	TermTable         terms;       ///< Interned nodes for the ID sink
+	Feed              feed;        ///< Input from serd_reader_feed()
+	SerdEnv*          env;         ///< Base URI and prefixes read so far
+	Directive*        directives;  ///< Directives read since checkpoint
+	size_t            n_directives; ///< Number of directives
+	bool              env_replaced; ///< True iff env replaced since checkpoint
+	Checkpoint        checkpoint;  ///< Last statement boundary
+	bool              sink_failed; ///< True iff a sink failed since input started
+	Cursor            resume;      ///< Start of next input, line 0 if unset
+	SerdReaderStats   stats;       ///< Counters, with bytes of closed sources
+	uint64_t          source_start; ///< Position where the source started
+	uint64_t          sink_ns;     ///< Time spent in sinks if timed
+	bool              timed;       ///< True iff time spent in sinks is measured
+	SerdProgressSink  progress_sink;
+	void*             progress_handle;
+	uint64_t          progress_interval;
+	uint64_t          next_progress; ///< Statement count to report progress at
 	SerdErrorSink     error_sink;
 	void*             error_handle;
 	Ref               rdf_first;
@@ -584,12 +1419,26 @@ struct SerdReaderImpl {
 	SerdStack         stack;
 	SerdSyntax        syntax;
 	unsigned          next_id;
+	unsigned          id_radix;    ///< Radix of generated blank IDs
 	SerdStatus        status;
 	uint8_t*          buf;
 	uint8_t*          bprefix;
 	size_t            bprefix_len;
-	bool              strict;     ///< True iff strict parsing
+	bool              strict;      ///< True iff strict parsing
+	bool              node_views;  ///< True iff nodes may point into input
+	bool              validating;  ///< True iff input is only checked
 	bool              seen_genid;
+	bool              seen_Bgenid; ///< True iff a `B' ID was read without error
+	bool              skipping;    ///< True iff input ended while skipping an error
+	bool              error_ended; ///< True iff a statement with an error ended
+	SkipState         skip;        ///< State of input skipped after an error
+	uint64_t          errors_left; ///< Number of errors to report before counting
+	uint64_t          n_errors[SERD_ERR_INTERNAL + 1]; ///< Errors by status
+	unsigned          read_ahead;  ///< Number of pages to read ahead, or zero
+	void* const*      thread_handles; ///< Statement handles for threads
+	unsigned          n_thread_handles; ///< Number of thread_handles
+	size_t            page_size;   ///< Size of pages for files, or zero for auto
+	size_t            high_water;  ///< Size to shrink stack to, or zero
 #ifdef SERD_STACK_CHECK
 	Ref*              allocs;     ///< Stack of push offsets
 	size_t            n_allocs;   ///< Number of stack pushes
@@ -607,20 +1456,138 @@ Ref push_node(SerdReader* reader,
               const char* str,
               size_t      n_bytes);
 
+Ref push_node_view(SerdReader*    reader,
+                   SerdType       type,
+                   const uint8_t* buf,
+                   size_t         n_bytes,
+                   size_t         n_chars);
+
 size_t genid_size(SerdReader* reader);
 Ref    blank_id(SerdReader* reader);
-void   set_blank_id(SerdReader* reader, Ref ref, size_t buf_size);
+void   set_blank_id(SerdReader* reader, Ref ref);
+
+/** Write the generated blank ID for `id` to `buf`, returning its length. */
+size_t write_genid(const SerdReader* reader, char* buf, unsigned id);
+
+/** Return the number of a generated ID from the digits after `b', or zero. */
+unsigned parse_genid(const SerdReader* reader, const char* digits, size_t len);
 
 SerdNode* deref(SerdReader* reader, Ref ref);
 
 Ref pop_node(SerdReader* reader, Ref ref);
 
+/** Pop every node above `size` off the stack, after an error. */
+void pop_to(SerdReader* reader, size_t size);
+
+/** Shrink the stack after a top-level statement if it has grown too large. */
+void trim_stack(SerdReader* reader);
+
 bool emit_statement(SerdReader* reader, ReadContext ctx, Ref o, Ref d, Ref l);
 
+/** Pass a statement to the statement sink, or add it to the batch. */
+SerdStatus
+serd_reader_emit_statement(SerdReader*        reader,
+                           SerdStatementFlags flags,
+                           const SerdNode*    graph,
+                           const SerdNode*    subject,
+                           const SerdNode*    predicate,
+                           const SerdNode*    object,
+                           const SerdNode*    object_datatype,
+                           const SerdNode*    object_lang);
+
+/** Count a statement which is passed on elsewhere, and report progress. */
+void
+serd_reader_count_statement(SerdReader* reader);
+
+/** Count an error with status `st`, and return true iff it is reported. */
+static inline bool
+serd_reader_count_error(SerdReader* reader, SerdStatus st)
+{
+	++reader->stats.n_errors;
+	++reader->n_errors[st];
+	if (!reader->errors_left) {
+		return false;
+	}
+
+	--reader->errors_left;
+	return true;
+}
+
+/** Pass a statement to the ID sink, with the IDs of its nodes. */
+SerdStatus
+serd_reader_emit_statement_ids(SerdReader*        reader,
+                               SerdStatementFlags flags,
+                               const SerdNode*    graph,
+                               const SerdNode*    subject,
+                               const SerdNode*    predicate,
+                               const SerdNode*    object,
+                               const SerdNode*    object_datatype,
+                               const SerdNode*    object_lang);
+
+/** Pass a base URI to the base sink, and track it for checkpoints. */
+SerdStatus
+serd_reader_emit_base(SerdReader* reader, const SerdNode* uri);
+
+/** Pass a prefix to the prefix sink, and track it for checkpoints. */
+SerdStatus
+serd_reader_emit_prefix(SerdReader*     reader,
+                        const SerdNode* name,
+                        const SerdNode* uri);
+
+/** Pass the end of an anonymous node to the end sink. */
+SerdStatus
+serd_reader_emit_end(SerdReader* reader, const SerdNode* node);
+
+/** Set the checkpoint to a statement boundary at `cur`. */
+void
+serd_reader_set_checkpoint(SerdReader* reader,
+                           Cursor      cur,
+                           unsigned    next_id,
+                           bool        seen_genid);
+
+/** Replace the base URI and prefixes of `reader` with those of `env`. */
+void
+serd_reader_set_env(SerdReader* reader, const SerdEnv* env);
+
+/** Set the checkpoint to the current position, after a complete statement. */
+static inline void
+serd_reader_checkpoint(SerdReader* reader)
+{
+	// Statements are only passed on in full and in order until a sink fails
+	if (!reader->source.eof && !reader->sink_failed) {
+		serd_byte_source_update_cursor(&reader->source);
+		serd_reader_set_checkpoint(
+			reader, reader->source.cur, reader->next_id, reader->seen_genid);
+	}
+}
+
+/**
+   Return the position of the start of new input named `name`.
+
+   This is the start of the document, unless serd_reader_resume() was called
+   since the last input started.
+*/
+Cursor
+serd_reader_start_cursor(SerdReader* reader, const uint8_t* name);
+
+/** Pass any batched statements to the batch sink. */
+SerdStatus
+serd_reader_flush_batch(SerdReader* reader);
+
 bool read_n3_statement(SerdReader* reader);
 bool read_nquadsDoc(SerdReader* reader);
 bool read_turtleTrigDoc(SerdReader* reader);
 
+/** Read an NTriples or NQuads statement, on a fast path for simple lines. */
+bool read_line_statement(SerdReader* reader);
+
+SerdStatus
+serd_reader_read_range(SerdReader*    reader,
+                       const uint8_t* buf,
+                       size_t         size,
+                       Cursor         cur,
+                       size_t*        n_read);
+
 typedef enum {
 	FIELD_NONE,
 	FIELD_SUBJECT,
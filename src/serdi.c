@@ -21,8 +21,13 @@
 #include <io.h>
 #endif
 
+#if defined(HAVE_FSTAT) && defined(HAVE_FILENO)
+#include <sys/stat.h>
+#endif
+
 #include <assert.h>
 #include <errno.h>
+#include <inttypes.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -55,13 +60,34 @@ get_syntax(const char* name)
 	return (SerdSyntax)0;
 }
 
+/// Extensions of compressed files, which are detected by their content
+static const char* const compressed_extensions[] = {
+	".gz", ".bz2", ".zst", NULL
+};
+
 static SerdSyntax
 guess_syntax(const char* filename)
 {
-	const char* ext = strrchr(filename, '.');
+	// Use the extension before that of a compressed file, like "x.ttl.gz"
+	const char* end = filename + strlen(filename);
+	for (const char* const* c = compressed_extensions; *c; ++c) {
+		const size_t len = strlen(*c);
+		if ((size_t)(end - filename) > len &&
+		    !serd_strncasecmp(end - len, *c, len)) {
+			end -= len;
+			break;
+		}
+	}
+
+	const char* ext = NULL;
+	for (const char* p = filename; p < end; ++p) {
+		ext = (*p == '.') ? p : ext;
+	}
+
 	if (ext) {
+		const size_t len = (size_t)(end - ext);
 		for (const Syntax* s = syntaxes; s->name; ++s) {
-			if (!serd_strncasecmp(s->extension, ext, strlen(ext))) {
+			if (!serd_strncasecmp(s->extension, ext, len)) {
 				return s->syntax;
 			}
 		}
@@ -69,6 +95,22 @@ guess_syntax(const char* filename)
 	return (SerdSyntax)0;
 }
 
+/// Return true iff `a` and `b` are the same file
+static bool
+same_file(FILE* a, FILE* b)
+{
+#if defined(HAVE_FSTAT) && defined(HAVE_FILENO)
+	struct stat sa;
+	struct stat sb;
+	return (!fstat(fileno(a), &sa) && !fstat(fileno(b), &sb) &&
+	        sa.st_dev == sb.st_dev && sa.st_ino == sb.st_ino);
+#else
+	(void)a;
+	(void)b;
+	return true;
+#endif
+}
+
 static int
 print_version(void)
 {
@@ -87,7 +129,21 @@ print_usage(const char* name, bool error)
 	fprintf(os, "%s", error ? "\n" : "");
 	fprintf(os, "Usage: %s [OPTION]... INPUT [BASE_URI]\n", name);
 	fprintf(os, "Read and write RDF syntax.\n");
-	fprintf(os, "Use - for INPUT to read from standard input.\n\n");
+	fprintf(os, "Use - for INPUT to read from standard input.\n");
+#if defined(HAVE_ZLIB) || defined(HAVE_BZLIB) || defined(HAVE_ZSTD)
+	fprintf(os, "Compressed INPUT is detected:");
+#    ifdef HAVE_ZLIB
+	fprintf(os, " gzip");
+#    endif
+#    ifdef HAVE_BZLIB
+	fprintf(os, " bzip2");
+#    endif
+#    ifdef HAVE_ZSTD
+	fprintf(os, " zstd");
+#    endif
+	fprintf(os, ".\n");
+#endif
+	fprintf(os, "\n");
 	fprintf(os, "  -a           Write ASCII output if possible.\n");
 	fprintf(os, "  -b           Fast bulk output for large serialisations.\n");
 	fprintf(os, "  -c PREFIX    Chop PREFIX from matching blank node IDs.\n");
@@ -95,16 +151,42 @@ print_usage(const char* name, bool error)
 	fprintf(os, "  -f           Keep full URIs in input (don't qualify).\n");
 	fprintf(os, "  -h           Display this help and exit.\n");
 	fprintf(os, "  -i SYNTAX    Input syntax: turtle/ntriples/trig/nquads.\n");
+	fprintf(os, "  -j THREADS   Read input file with THREADS threads.\n");
+	fprintf(os, "  -k PAGES     Read PAGES pages ahead and write as many behind.\n");
 	fprintf(os, "  -l           Lax (non-strict) parsing.\n");
+	fprintf(os, "  -n SIZE      Read input in pages of SIZE bytes, or auto.\n");
 	fprintf(os, "  -o SYNTAX    Output syntax: turtle/ntriples/nquads.\n");
 	fprintf(os, "  -p PREFIX    Add PREFIX to blank node IDs.\n");
 	fprintf(os, "  -q           Suppress all output except data.\n");
 	fprintf(os, "  -r ROOT_URI  Keep relative URIs within ROOT_URI.\n");
 	fprintf(os, "  -s INPUT     Parse INPUT as string (terminates options).\n");
+	fprintf(os, "  -t           Print throughput to stderr while reading.\n");
 	fprintf(os, "  -v           Display version information and exit.\n");
+	fprintf(os, "  -V           Validate input only, and write no output.\n");
+	fprintf(os, "  -w SIZE      Write output in blocks of SIZE bytes, or auto.\n");
 	return error ? 1 : 0;
 }
 
+/// Parse a size like "4096", "64K", "1M", or "auto" (zero)
+static bool
+parse_size(const char* str, size_t* size)
+{
+	if (!strcmp(str, "auto")) {
+		*size = 0;
+		return true;
+	}
+
+	char*               end = NULL;
+	const unsigned long n   = strtoul(str, &end, 10);
+	switch (*end) {
+	case 'K': case 'k': *size = n << 10U; ++end; break;
+	case 'M': case 'm': *size = n << 20U; ++end; break;
+	default:            *size = n;
+	}
+
+	return end != str && !*end && *size > 0;
+}
+
 static int
 missing_arg(const char* name, char opt)
 {
@@ -120,6 +202,41 @@ quiet_error_sink(void* handle, const SerdError* e)
 	return SERD_SUCCESS;
 }
 
+typedef struct {
+	uint64_t start;  ///< Time reading started in nanoseconds
+	uint64_t last;   ///< Time of the last report in nanoseconds
+} Progress;
+
+static void
+print_throughput(const Progress* progress, const SerdReaderStats* stats)
+{
+	const double secs = (double)(serd_time_ns() - progress->start) * 1e-9;
+	const double mb   = (double)stats->n_bytes / 1e6;
+	fprintf(stderr, "serdi: %" PRIu64 " statements, %.1f MB",
+	        stats->n_statements, mb);
+
+	if (stats->n_errors) {
+		fprintf(stderr, ", %" PRIu64 " errors", stats->n_errors);
+	}
+
+	if (secs > 0.0) {
+		fprintf(stderr, " in %.2f s (%.0f statements/s, %.1f MB/s)",
+		        secs, (double)stats->n_statements / secs, mb / secs);
+	}
+	fprintf(stderr, "\n");
+}
+
+static void
+progress_sink(void* handle, const SerdReaderStats* stats)
+{
+	Progress* const progress = (Progress*)handle;
+	const uint64_t  now      = serd_time_ns();
+	if (now - progress->last >= 1000000000U) {  // At most once a second
+		progress->last = now;
+		print_throughput(progress, stats);
+	}
+}
+
 int
 main(int argc, char** argv)
 {
@@ -137,6 +254,12 @@ main(int argc, char** argv)
 	bool           full_uris     = false;
 	bool           lax           = false;
 	bool           quiet         = false;
+	bool           throughput    = false;
+	bool           validate      = false;
+	unsigned       n_threads     = 1;
+	unsigned       read_ahead    = 0;
+	size_t         page_size     = 4096;
+	size_t         block_size    = 1;
 	const uint8_t* in_name       = NULL;
 	const uint8_t* add_prefix    = NULL;
 	const uint8_t* chop_prefix   = NULL;
@@ -161,8 +284,12 @@ main(int argc, char** argv)
 			lax = true;
 		} else if (argv[a][1] == 'q') {
 			quiet = true;
+		} else if (argv[a][1] == 't') {
+			throughput = true;
 		} else if (argv[a][1] == 'v') {
 			return print_version();
+		} else if (argv[a][1] == 'V') {
+			validate = true;
 		} else if (argv[a][1] == 's') {
 			in_name = (const uint8_t*)"(string)";
 			from_file = false;
@@ -180,6 +307,28 @@ main(int argc, char** argv)
 			} else if (!(output_syntax = get_syntax(argv[a]))) {
 				return print_usage(argv[0], true);
 			}
+		} else if (argv[a][1] == 'j') {
+			if (++a == argc) {
+				return missing_arg(argv[0], 'j');
+			}
+			n_threads = (unsigned)strtoul(argv[a], NULL, 10);
+		} else if (argv[a][1] == 'k') {
+			if (++a == argc) {
+				return missing_arg(argv[0], 'k');
+			}
+			read_ahead = (unsigned)strtoul(argv[a], NULL, 10);
+		} else if (argv[a][1] == 'n') {
+			if (++a == argc) {
+				return missing_arg(argv[0], 'n');
+			} else if (!parse_size(argv[a], &page_size)) {
+				return print_usage(argv[0], true);
+			}
+		} else if (argv[a][1] == 'w') {
+			if (++a == argc) {
+				return missing_arg(argv[0], 'w');
+			} else if (!parse_size(argv[a], &block_size)) {
+				return print_usage(argv[0], true);
+			}
 		} else if (argv[a][1] == 'p') {
 			if (++a == argc) {
 				return missing_arg(argv[0], 'p');
@@ -269,17 +418,31 @@ main(int argc, char** argv)
 		output_syntax, (SerdStyle)output_style,
 		env, &base_uri, serd_file_sink, out_fd);
 
-	SerdReader* reader = serd_reader_new(
-		input_syntax, writer, NULL,
-		(SerdBaseSink)serd_writer_set_base_uri,
-		(SerdPrefixSink)serd_writer_set_prefix,
-		(SerdStatementSink)serd_writer_write_statement,
-		(SerdEndSink)serd_writer_end_anon);
+	SerdReader* reader = validate
+		? serd_reader_new(input_syntax, NULL, NULL, NULL, NULL, NULL, NULL)
+		: serd_reader_new(input_syntax, writer, NULL,
+		                  (SerdBaseSink)serd_writer_set_base_uri,
+		                  (SerdPrefixSink)serd_writer_set_prefix,
+		                  (SerdStatementSink)serd_writer_write_statement,
+		                  (SerdEndSink)serd_writer_end_anon);
 
 	serd_reader_set_strict(reader, !lax);
+	serd_reader_set_read_ahead(reader, read_ahead);
+	serd_reader_set_page_size(reader, page_size);
+	serd_reader_set_validate_only(reader, validate);
 	if (quiet) {
-		serd_reader_set_error_sink(reader, quiet_error_sink, NULL);
+		serd_reader_set_error_limit(reader, 0);
 		serd_writer_set_error_sink(writer, quiet_error_sink, NULL);
+	} else if (validate) {
+		serd_reader_set_error_limit(reader, 1);  // Only count the rest
+	}
+
+	if (block_size != 1) {
+		serd_writer_set_block_size(writer, block_size);
+	}
+	if (!same_file(out_fd, stderr)) {
+		// Errors would be written out of order, or over output
+		serd_writer_set_write_behind(writer, read_ahead);
 	}
 
 	SerdNode root = serd_node_from_string(SERD_URI, root_uri);
@@ -287,11 +450,17 @@ main(int argc, char** argv)
 	serd_writer_chop_blank_prefix(writer, chop_prefix);
 	serd_reader_add_blank_prefix(reader, add_prefix);
 
+	Progress progress = { serd_time_ns(), serd_time_ns() };
+	if (throughput) {
+		serd_reader_set_progress_sink(reader, progress_sink, &progress, 65536);
+	}
+
 	SerdStatus status = SERD_SUCCESS;
 	if (!from_file) {
 		status = serd_reader_read_string(reader, input);
 	} else if (bulk_read) {
-		status = serd_reader_read_file_handle(reader, in_fd, in_name);
+		status = serd_reader_read_file_parallel(
+			reader, in_fd, in_name, n_threads);
 	} else {
 		status = serd_reader_start_stream(reader, in_fd, in_name, false);
 		while (!status) {
@@ -300,6 +469,19 @@ main(int argc, char** argv)
 		serd_reader_end_stream(reader);
 	}
 
+	const SerdReaderStats stats    = serd_reader_get_stats(reader);
+	const uint64_t        n_errors = stats.n_errors;
+	if (throughput) {
+		print_throughput(&progress, &stats);
+	}
+
+	if (validate && n_errors) {
+		if (n_errors > 1 && !quiet && !throughput) {
+			SERDI_ERRORF("%" PRIu64 " errors\n", n_errors);
+		}
+		status = status ? status : SERD_ERR_BAD_SYNTAX;  // Even if lax
+	}
+
 	serd_reader_free(reader);
 	serd_writer_finish(writer);
 	serd_writer_free(writer);
@@ -0,0 +1,319 @@
+/*
+  Copyright 2019 David Robillard <http://drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "serd_internal.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+  Nodes are interned in two generations, each a hash table with open
+  addressing and an arena for the strings, so the memory used is fixed.  New
+  nodes are added to the newer generation, and nodes found in the older one
+  are copied to it with the same ID.  When the newer generation is full, the
+  older one is dropped and reused as the newer, which evicts every node that
+  was not read while it was the newer generation.  This keeps frequent nodes
+  like predicates with their IDs forever, without tracking recency per node.
+*/
+
+#define TERM_TABLE_DEFAULT_CAPACITY (16U * 1024U * 1024U)
+#define TERM_TABLE_MIN_CAPACITY     8192U
+#define TERM_HASH_MUL               0x9E3779B97F4A7C15ULL
+
+static uint64_t
+term_hash(const SerdNode* node)
+{
+	const uint8_t* const buf = node->buf;
+	const size_t         len = node->n_bytes;
+
+	uint64_t h = ((uint64_t)len << 8U | (uint64_t)node->type) * TERM_HASH_MUL;
+	size_t   i = 0;
+	for (; i + 8 <= len; i += 8) {
+		uint64_t word = 0;
+		memcpy(&word, buf + i, 8);
+		h = (h ^ word) * TERM_HASH_MUL;
+		h ^= h >> 32U;
+	}
+
+	if (i < len) {
+		uint64_t word = 0;
+		memcpy(&word, buf + i, len - i);
+		h = (h ^ word) * TERM_HASH_MUL;
+	}
+
+	h ^= h >> 29U;
+	h *= 0xBF58476D1CE4E5B9ULL;
+	return h ^ (h >> 32U);
+}
+
+/// Return the size of the entry for a node of `n_bytes` in an arena
+static inline size_t
+entry_size(size_t n_bytes)
+{
+	const size_t align = sizeof(SerdTermId);
+	return (sizeof(TermEntry) + n_bytes + align - 1) / align * align;
+}
+
+static bool
+gen_init(TermGeneration* gen, size_t size)
+{
+	// A quarter of the memory for slots, kept at most half full
+	size_t n_slots = 16;
+	while (n_slots * 2 * sizeof(TermSlot) <= size / 4) {
+		n_slots *= 2;
+	}
+
+	gen->slots    = (TermSlot*)calloc(n_slots, sizeof(TermSlot));
+	gen->n_slots  = n_slots;
+	gen->n_terms  = 0;
+	gen->n_live   = 0;
+	gen->capacity = size - n_slots * sizeof(TermSlot);
+	gen->arena    = (uint8_t*)malloc(gen->capacity);
+	gen->size     = 0;
+	return gen->slots && gen->arena;
+}
+
+static void
+gen_free(TermGeneration* gen)
+{
+	free(gen->slots);
+	free(gen->arena);
+	memset(gen, '\0', sizeof(TermGeneration));
+}
+
+static void
+gen_clear(TermGeneration* gen)
+{
+	memset(gen->slots, '\0', gen->n_slots * sizeof(TermSlot));
+	gen->n_terms = 0;
+	gen->n_live  = 0;
+	gen->size    = 0;
+}
+
+/// Return true iff `e` is an entry for `node`
+static inline bool
+entry_matches(const TermEntry* e, const SerdNode* node)
+{
+	return e->type == node->type && e->n_bytes == node->n_bytes &&
+	       !memcmp(e + 1, node->buf, node->n_bytes);
+}
+
+/// Return the slot for `node` in `gen`, which is empty if it is not there
+static TermSlot*
+gen_find(const TermGeneration* gen, const SerdNode* node, uint64_t hash)
+{
+	const size_t mask = gen->n_slots - 1;
+	for (size_t i = (size_t)hash & mask;; i = (i + 1) & mask) {
+		TermSlot* const slot = &gen->slots[i];
+		if (!slot->entry ||
+		    (slot->hash == hash &&
+		     entry_matches((const TermEntry*)(gen->arena + slot->entry - 1),
+		                   node))) {
+			return slot;
+		}
+	}
+}
+
+/// Start loading the slot for `hash` in `gen` into the cache
+static inline void
+gen_prefetch(const TermGeneration* gen, uint64_t hash)
+{
+#ifdef __GNUC__
+	__builtin_prefetch(&gen->slots[(size_t)hash & (gen->n_slots - 1)]);
+#else
+	(void)gen;
+	(void)hash;
+#endif
+}
+
+/// Return true iff a node of `n_bytes` can be added to `gen`
+static inline bool
+gen_has_room(const TermGeneration* gen, size_t n_bytes)
+{
+	return gen->n_terms < gen->n_slots / 2 &&
+	       gen->size + entry_size(n_bytes) <= gen->capacity;
+}
+
+/// Add `node` to `gen` with `id`, in `slot` which must be empty
+static const TermEntry*
+gen_insert(TermGeneration* gen,
+           TermSlot*       slot,
+           const SerdNode* node,
+           uint64_t        hash,
+           SerdTermId      id)
+{
+	TermEntry* const e = (TermEntry*)(gen->arena + gen->size);
+	e->id      = id;
+	e->n_bytes = node->n_bytes;
+	e->type    = node->type;
+	memcpy(e + 1, node->buf, node->n_bytes);
+
+	slot->hash  = hash;
+	slot->entry = gen->size + 1;
+	gen->size  += entry_size(node->n_bytes);
+	++gen->n_terms;
+	++gen->n_live;
+	return e;
+}
+
+/// Drop the older generation and reuse it as the newer
+static void
+terms_rotate(SerdReader* reader)
+{
+	TermTable* const     terms = &reader->terms;
+	const TermGeneration older = terms->gens[1];
+
+	reader->stats.n_term_evictions += older.n_live;
+	terms->gens[1] = terms->gens[0];
+	terms->gens[0] = older;
+	gen_clear(&terms->gens[0]);
+	memset(terms->last, '\0', sizeof(terms->last));
+}
+
+/// Add `node` to the newer generation in `slot`, making room if necessary
+static const TermEntry*
+terms_insert(SerdReader*     reader,
+             TermSlot*       slot,
+             const SerdNode* node,
+             uint64_t        hash,
+             SerdTermId      id)
+{
+	TermGeneration* const newer = &reader->terms.gens[0];
+	if (!gen_has_room(newer, node->n_bytes)) {
+		terms_rotate(reader);
+		if (!gen_has_room(newer, node->n_bytes)) {
+			return NULL;  // Too large to ever fit
+		}
+		slot = gen_find(newer, node, hash);
+	}
+
+	return gen_insert(newer, slot, node, hash, id);
+}
+
+/// Return the ID of `node`, and set `last` to its entry in the newer table
+static SerdTermId
+terms_intern(SerdReader*       reader,
+             const SerdNode*   node,
+             uint64_t          hash,
+             const TermEntry** last)
+{
+	TermTable* const      terms = &reader->terms;
+	TermGeneration* const newer = &terms->gens[0];
+	TermSlot* const       slot  = gen_find(newer, node, hash);
+	if (slot->entry) {
+		*last = (const TermEntry*)(newer->arena + slot->entry - 1);
+		++reader->stats.n_term_hits;
+		return (*last)->id;
+	}
+
+	TermGeneration* const older    = &terms->gens[1];
+	const TermSlot* const old_slot = gen_find(older, node, hash);
+	if (old_slot->entry) {
+		// Copy to the newer generation so it survives the next rotation
+		const SerdTermId id =
+			((const TermEntry*)(older->arena + old_slot->entry - 1))->id;
+
+		--older->n_live;
+		*last = terms_insert(reader, slot, node, hash, id);
+		++reader->stats.n_term_hits;
+		return id;
+	}
+
+	const SerdTermId id = terms->next_id++;
+	*last = terms_insert(reader, slot, node, hash, id);
+	++reader->stats.n_term_misses;
+	return id;
+}
+
+SerdStatus
+serd_reader_emit_statement_ids(SerdReader*        reader,
+                               SerdStatementFlags flags,
+                               const SerdNode*    graph,
+                               const SerdNode*    subject,
+                               const SerdNode*    predicate,
+                               const SerdNode*    object,
+                               const SerdNode*    object_datatype,
+                               const SerdNode*    object_lang)
+{
+	TermTable* const    terms     = &reader->terms;
+	const SerdStatement statement = { flags,     graph,  subject,
+	                                  predicate, object, object_datatype,
+	                                  object_lang };
+
+	const SerdNode* const nodes[] = { graph,  subject,         predicate,
+	                                  object, object_datatype, object_lang };
+
+	/* Nodes are often the same as in the last statement, which are checked
+	   first.  Others are hashed first so their slots load together. */
+	SerdTermId n[6]      = { 0, 0, 0, 0, 0, 0 };
+	uint64_t   hashes[6] = { 0, 0, 0, 0, 0, 0 };
+	for (unsigned i = 0; i < 6; ++i) {
+		if (!nodes[i]) {
+			terms->last[i] = NULL;
+		} else if (terms->last[i] && entry_matches(terms->last[i], nodes[i])) {
+			n[i] = terms->last[i]->id;
+			++reader->stats.n_term_hits;
+		} else {
+			hashes[i] = term_hash(nodes[i]);
+			gen_prefetch(&terms->gens[0], hashes[i]);
+			gen_prefetch(&terms->gens[1], hashes[i]);
+		}
+	}
+
+	for (unsigned i = 0; i < 6; ++i) {
+		if (nodes[i] && !n[i]) {
+			n[i] = terms_intern(reader, nodes[i], hashes[i], &terms->last[i]);
+		}
+	}
+
+	const SerdStatementIds ids = { n[0], n[1], n[2], n[3], n[4], n[5] };
+
+	const uint64_t   t0 = reader->timed ? serd_time_ns() : 0;
+	const SerdStatus st = terms->sink(reader->handle, &statement, &ids);
+	if (reader->timed) {
+		reader->sink_ns += serd_time_ns() - t0;
+	}
+	return st;
+}
+
+void
+serd_reader_set_statement_id_sink(SerdReader*         reader,
+                                  SerdStatementIdSink id_sink,
+                                  size_t              capacity)
+{
+	TermTable* const terms = &reader->terms;
+
+	gen_free(&terms->gens[0]);
+	gen_free(&terms->gens[1]);
+	memset(terms, '\0', sizeof(TermTable));
+
+	if (id_sink) {
+		const size_t size = (!capacity ? TERM_TABLE_DEFAULT_CAPACITY
+		                     : capacity < TERM_TABLE_MIN_CAPACITY
+		                     ? TERM_TABLE_MIN_CAPACITY
+		                     : capacity);
+		if (gen_init(&terms->gens[0], size / 2) &&
+		    gen_init(&terms->gens[1], size / 2)) {
+			terms->sink    = id_sink;
+			terms->next_id = 1;
+		} else {
+			gen_free(&terms->gens[0]);
+			gen_free(&terms->gens[1]);
+		}
+	}
+}
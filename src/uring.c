@@ -0,0 +1,463 @@
+/*
+  Copyright 2019 David Robillard <http://drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "serd_internal.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_IO_URING
+#    include <fcntl.h>
+#    include <linux/io_uring.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <sys/syscall.h>
+#    include <sys/uio.h>
+#    include <unistd.h>
+
+/*
+  A minimal io_uring, used directly through system calls so there is no
+  dependency on liburing.  Every buffer has at most one operation in flight,
+  so there are never more operations than entries in the submission queue.
+*/
+
+/// An operation on a buffer
+typedef struct {
+	int64_t offset;   ///< Offset in file, or -1 for the file position
+	size_t  len;      ///< Number of bytes to read or write
+	int32_t res;      ///< Result, bytes transferred or a negative error code
+	bool    write;    ///< True for write, false for read
+	bool    pending;  ///< True iff submitted but not yet reaped
+	bool    finished; ///< True iff reaped and completed
+} Op;
+
+struct SerdUringImpl {
+	int                  fd;          ///< File descriptor to read or write
+	int                  ring_fd;     ///< File descriptor of ring
+	void*                sq_map;      ///< Mapping of submission queue ring
+	size_t               sq_map_size; ///< Size of sq_map
+	void*                cq_map;      ///< Mapping of completion queue ring
+	size_t               cq_map_size; ///< Size of cq_map
+	struct io_uring_sqe* sqes;        ///< Submission queue entries
+	size_t               sqes_size;   ///< Size of sqes mapping
+	unsigned*            sq_tail;     ///< Tail of submission queue
+	unsigned*            sq_mask;     ///< Index mask of submission queue
+	unsigned*            sq_array;    ///< Submission queue entry indices
+	unsigned*            cq_head;     ///< Head of completion queue
+	unsigned*            cq_tail;     ///< Tail of completion queue
+	unsigned*            cq_mask;     ///< Index mask of completion queue
+	struct io_uring_cqe* cqes;        ///< Completion queue entries
+	unsigned             to_submit;   ///< Entries not yet taken by the kernel
+	uint8_t*             bufs;        ///< Buffers, contiguous
+	size_t               buf_size;    ///< Size of each buffer
+	unsigned             n_bufs;      ///< Number of buffers
+	bool                 registered;  ///< True iff buffers are registered
+	struct iovec*        iovs;        ///< Buffer vectors
+	Op*                  ops;         ///< Operation on each buffer
+};
+
+static int
+uring_enter(int ring_fd, unsigned to_submit, unsigned min_complete,
+            unsigned flags)
+{
+	return (int)syscall(__NR_io_uring_enter,
+	                    ring_fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+/** Reap all available completions. */
+static void
+serd_uring_reap(SerdUring* ring)
+{
+	unsigned       head = *ring->cq_head;
+	const unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+	for (; head != tail; ++head) {
+		const struct io_uring_cqe* cqe = &ring->cqes[head & *ring->cq_mask];
+		Op* const                  op  = &ring->ops[cqe->user_data];
+		op->res     = cqe->res;
+		op->pending = false;
+	}
+	__atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+}
+
+/** Finish a short or interrupted operation synchronously. */
+static int64_t
+serd_uring_complete(SerdUring* ring, unsigned i)
+{
+	const Op* const op  = &ring->ops[i];
+	uint8_t* const  buf = ring->bufs + i * ring->buf_size;
+	size_t          done;
+	if (op->res >= 0) {
+		done = (size_t)op->res;
+	} else if (op->res == -EAGAIN || op->res == -EINTR) {
+		done = 0;
+	} else {
+		return op->res;
+	}
+
+	while (done < op->len) {
+		const off_t   off = (off_t)(op->offset + (int64_t)done);
+		const ssize_t r   = (op->write
+		                     ? (op->offset < 0
+		                        ? write(ring->fd, buf + done, op->len - done)
+		                        : pwrite(ring->fd, buf + done, op->len - done,
+		                                 off))
+		                     : (op->offset < 0
+		                        ? read(ring->fd, buf + done, op->len - done)
+		                        : pread(ring->fd, buf + done, op->len - done,
+		                                off)));
+		if (r < 0 && errno != EINTR) {
+			return -errno;
+		} else if (r == 0) {
+			break;  // End of file
+		} else if (r > 0) {
+			done += (size_t)r;
+		}
+	}
+
+	return (int64_t)done;
+}
+
+static void
+serd_uring_unmap(SerdUring* ring)
+{
+	if (ring->sqes) {
+		munmap(ring->sqes, ring->sqes_size);
+	}
+	if (ring->cq_map && ring->cq_map != ring->sq_map) {
+		munmap(ring->cq_map, ring->cq_map_size);
+	}
+	if (ring->sq_map) {
+		munmap(ring->sq_map, ring->sq_map_size);
+	}
+}
+
+SerdUring*
+serd_uring_new(int fd, unsigned n_bufs, size_t buf_size)
+{
+	struct io_uring_params params;
+	memset(&params, '\0', sizeof(params));
+
+	const int ring_fd = (int)syscall(__NR_io_uring_setup, n_bufs, &params);
+	if (ring_fd < 0) {
+		return NULL;  // Not supported by the kernel or not permitted
+	}
+
+	SerdUring* const ring = (SerdUring*)calloc(1, sizeof(SerdUring));
+	ring->fd          = fd;
+	ring->ring_fd     = ring_fd;
+	ring->sq_map_size = (params.sq_off.array +
+	                     params.sq_entries * sizeof(unsigned));
+	ring->cq_map_size = (params.cq_off.cqes +
+	                     params.cq_entries * sizeof(struct io_uring_cqe));
+	ring->sqes_size   = params.sq_entries * sizeof(struct io_uring_sqe);
+	if (params.features & IORING_FEAT_SINGLE_MMAP) {
+		if (ring->cq_map_size > ring->sq_map_size) {
+			ring->sq_map_size = ring->cq_map_size;
+		}
+		ring->cq_map_size = ring->sq_map_size;
+	}
+
+	void* map = mmap(NULL, ring->sq_map_size, PROT_READ | PROT_WRITE,
+	                 MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+	if (map == MAP_FAILED) {
+		goto fail;
+	}
+	ring->sq_map = map;
+
+	if (params.features & IORING_FEAT_SINGLE_MMAP) {
+		ring->cq_map = ring->sq_map;
+	} else if ((map = mmap(NULL, ring->cq_map_size, PROT_READ | PROT_WRITE,
+	                       MAP_SHARED | MAP_POPULATE, ring_fd,
+	                       IORING_OFF_CQ_RING)) == MAP_FAILED) {
+		goto fail;
+	} else {
+		ring->cq_map = map;
+	}
+
+	if ((map = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+	                MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES)) ==
+	    MAP_FAILED) {
+		goto fail;
+	}
+	ring->sqes = (struct io_uring_sqe*)map;
+
+	uint8_t* const sq = (uint8_t*)ring->sq_map;
+	uint8_t* const cq = (uint8_t*)ring->cq_map;
+	ring->sq_tail  = (unsigned*)(sq + params.sq_off.tail);
+	ring->sq_mask  = (unsigned*)(sq + params.sq_off.ring_mask);
+	ring->sq_array = (unsigned*)(sq + params.sq_off.array);
+	ring->cq_head  = (unsigned*)(cq + params.cq_off.head);
+	ring->cq_tail  = (unsigned*)(cq + params.cq_off.tail);
+	ring->cq_mask  = (unsigned*)(cq + params.cq_off.ring_mask);
+	ring->cqes     = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+
+	ring->buf_size = buf_size;
+	ring->n_bufs   = n_bufs;
+	ring->iovs     = (struct iovec*)calloc(n_bufs, sizeof(struct iovec));
+	ring->ops      = (Op*)calloc(n_bufs, sizeof(Op));
+	if (!(ring->bufs = (uint8_t*)serd_bufalloc(n_bufs * buf_size))) {
+		goto fail;
+	}
+
+	for (unsigned i = 0; i < n_bufs; ++i) {
+		ring->iovs[i].iov_base = ring->bufs + i * buf_size;
+		ring->iovs[i].iov_len  = buf_size;
+	}
+
+	/* Registered buffers are pinned in memory, which may exceed the locked
+	   memory limit, in which case plain vectored I/O is used instead. */
+	ring->registered = !syscall(__NR_io_uring_register, ring_fd,
+	                            IORING_REGISTER_BUFFERS, ring->iovs, n_bufs);
+
+	return ring;
+
+fail:
+	serd_uring_unmap(ring);
+	close(ring_fd);
+	free(ring->bufs);
+	free(ring->ops);
+	free(ring->iovs);
+	free(ring);
+	return NULL;
+}
+
+uint8_t*
+serd_uring_buf(const SerdUring* ring, unsigned i)
+{
+	return ring->bufs + i * ring->buf_size;
+}
+
+void
+serd_uring_submit(SerdUring* ring,
+                  unsigned   i,
+                  bool       write,
+                  size_t     len,
+                  int64_t    offset)
+{
+	assert(!ring->ops[i].pending);
+	assert(len <= ring->buf_size);
+
+	const unsigned       tail = *ring->sq_tail;
+	const unsigned       idx  = tail & *ring->sq_mask;
+	struct io_uring_sqe* sqe  = &ring->sqes[idx];
+	memset(sqe, '\0', sizeof(*sqe));
+	sqe->fd        = ring->fd;
+	sqe->off       = (uint64_t)offset;
+	sqe->user_data = i;
+	if (ring->registered) {
+		sqe->opcode    = write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+		sqe->addr      = (uint64_t)(uintptr_t)ring->iovs[i].iov_base;
+		sqe->len       = (uint32_t)len;
+		sqe->buf_index = (uint16_t)i;
+	} else {
+		ring->iovs[i].iov_len = len;
+		sqe->opcode = write ? IORING_OP_WRITEV : IORING_OP_READV;
+		sqe->addr   = (uint64_t)(uintptr_t)&ring->iovs[i];
+		sqe->len    = 1;
+	}
+
+	ring->ops[i].offset  = offset;
+	ring->ops[i].len     = len;
+	ring->ops[i].res      = 0;
+	ring->ops[i].write    = write;
+	ring->ops[i].pending  = true;
+	ring->ops[i].finished = false;
+
+	ring->sq_array[idx] = idx;
+	__atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+	// Submit now, if the kernel is busy it will be retried when waiting
+	const int n_submitted = uring_enter(ring->ring_fd, ++ring->to_submit, 0, 0);
+	if (n_submitted > 0) {
+		ring->to_submit -= (unsigned)n_submitted;
+	}
+}
+
+int64_t
+serd_uring_wait(SerdUring* ring, unsigned i)
+{
+	Op* const op = &ring->ops[i];
+	while (op->pending) {
+		serd_uring_reap(ring);
+		if (op->pending) {
+			const int n_submitted = uring_enter(
+				ring->ring_fd, ring->to_submit, 1, IORING_ENTER_GETEVENTS);
+			if (n_submitted > 0) {
+				ring->to_submit -= (unsigned)n_submitted;
+			} else if (n_submitted < 0 && errno != EINTR &&
+			           errno != EAGAIN && errno != EBUSY) {
+				return -errno;
+			}
+		}
+	}
+
+	if (!op->finished) {
+		op->res      = (int32_t)serd_uring_complete(ring, i);
+		op->finished = true;
+	}
+
+	return op->res;
+}
+
+void
+serd_uring_free(SerdUring* ring)
+{
+	for (unsigned i = 0; i < ring->n_bufs; ++i) {
+		if (ring->ops[i].pending) {
+			serd_uring_wait(ring, i);
+		}
+	}
+
+	serd_uring_unmap(ring);
+	close(ring->ring_fd);
+	free(ring->bufs);
+	free(ring->ops);
+	free(ring->iovs);
+	free(ring);
+}
+
+/// Blocks written to a file behind the writer
+struct SerdWriteBehindImpl {
+	SerdUring* ring;      ///< Ring with a buffer for each block
+	FILE*      file;      ///< Output file
+	unsigned   cur;       ///< Index of the block being filled
+	int64_t    offset;    ///< Offset of the next block, or -1 to append
+};
+
+SerdStatus
+serd_byte_sink_start_write_behind(SerdByteSink* bsink, unsigned n_blocks)
+{
+	if (bsink->sink != serd_file_sink || bsink->behind ||
+	    bsink->block_size <= 1 || n_blocks < 2) {
+		return SERD_FAILURE;
+	}
+
+	FILE* const file = (FILE*)bsink->stream;
+	const int   fd   = fileno(file);
+	struct stat st;
+	if (fd < 0 || fstat(fd, &st)) {
+		return SERD_FAILURE;
+	}
+
+	serd_byte_sink_flush(bsink);
+	fflush(file);
+
+	/* Blocks of regular files are written at their offsets, so several can be
+	   in flight.  Otherwise, they are appended one at a time, in order. */
+	const int flags  = fcntl(fd, F_GETFL);
+	int64_t   offset = -1;
+	if (S_ISREG(st.st_mode) && flags >= 0 && !(flags & O_APPEND)) {
+		offset = (int64_t)ftello(file);
+	}
+
+	SerdUring* const ring = serd_uring_new(fd, n_blocks, bsink->block_size);
+	if (!ring) {
+		return SERD_FAILURE;
+	}
+
+	SerdWriteBehind* const behind =
+		(SerdWriteBehind*)calloc(1, sizeof(SerdWriteBehind));
+	behind->ring   = ring;
+	behind->file   = file;
+	behind->offset = offset;
+
+	free(bsink->buf);
+	bsink->buf    = serd_uring_buf(ring, 0);
+	bsink->size   = 0;
+	bsink->behind = behind;
+	return SERD_SUCCESS;
+}
+
+void
+serd_write_behind_flush(SerdByteSink* bsink)
+{
+	SerdWriteBehind* const behind = bsink->behind;
+	SerdUring* const       ring   = behind->ring;
+	const unsigned         n      = ring->n_bufs;
+
+	if (behind->offset < 0) {
+		serd_uring_wait(ring, (behind->cur + n - 1) % n);
+	}
+
+	serd_uring_submit(ring, behind->cur, true, bsink->size, behind->offset);
+	if (behind->offset >= 0) {
+		behind->offset += (int64_t)bsink->size;
+	}
+
+	// Continue in the next block once its previous write is finished
+	behind->cur = (behind->cur + 1) % n;
+	serd_uring_wait(ring, behind->cur);
+	bsink->buf  = serd_uring_buf(ring, behind->cur);
+	bsink->size = 0;
+}
+
+void
+serd_write_behind_sync(SerdByteSink* bsink)
+{
+	SerdWriteBehind* const behind = bsink->behind;
+	for (unsigned i = 0; i < behind->ring->n_bufs; ++i) {
+		serd_uring_wait(behind->ring, i);
+	}
+
+	if (behind->offset >= 0) {
+		fseeko(behind->file, (off_t)behind->offset, SEEK_SET);
+	}
+}
+
+void
+serd_write_behind_free(SerdByteSink* bsink)
+{
+	serd_write_behind_sync(bsink);
+	serd_uring_free(bsink->behind->ring);
+	free(bsink->behind);
+	bsink->behind = NULL;
+	bsink->buf    = NULL;
+}
+
+#else
+
+SerdStatus
+serd_byte_sink_start_write_behind(SerdByteSink* bsink, unsigned n_blocks)
+{
+	(void)bsink;
+	(void)n_blocks;
+	return SERD_FAILURE;
+}
+
+// Without io_uring, write-behind never starts so these are never called
+
+void
+serd_write_behind_flush(SerdByteSink* bsink)
+{
+	(void)bsink;
+}
+
+void
+serd_write_behind_sync(SerdByteSink* bsink)
+{
+	(void)bsink;
+}
+
+void
+serd_write_behind_free(SerdByteSink* bsink)
+{
+	(void)bsink;
+}
+
+#endif  // HAVE_IO_URING
@@ -96,6 +96,9 @@ struct SerdWriterImpl {
 	uint8_t*      bprefix;
 	size_t        bprefix_len;
 	Sep           last_sep;
+	unsigned      write_behind;
+	uint64_t      n_bytes;       ///< Number of bytes written
+	uint64_t      n_statements;  ///< Number of statements written
 	bool          empty;
 };
 
@@ -160,6 +163,7 @@ copy_node(SerdNode* dst, const SerdNode* src)
 static inline size_t
 sink(const void* buf, size_t len, SerdWriter* writer)
 {
+	writer->n_bytes += len;
 	return serd_byte_sink_write(buf, len, &writer->byte_sink);
 }
 
@@ -685,6 +689,8 @@ serd_writer_write_statement(SerdWriter*        writer,
 		return SERD_ERR_BAD_ARG;
 	}
 
+	++writer->n_statements;
+
 #define TRY(write_result) \
 	if (!(write_result)) { \
 		return SERD_ERR_UNKNOWN; \
@@ -840,6 +846,9 @@ serd_writer_finish(SerdWriter* writer)
 		write_sep(writer, SEP_GRAPH_END);
 	}
 	serd_byte_sink_flush(&writer->byte_sink);
+	if (writer->byte_sink.behind) {
+		serd_write_behind_sync(&writer->byte_sink);
+	}
 	writer->indent = 0;
 	return free_context(writer);
 }
@@ -878,6 +887,56 @@ serd_writer_set_error_sink(SerdWriter*   writer,
 	writer->error_handle = error_handle;
 }
 
+void
+serd_writer_set_block_size(SerdWriter* writer, size_t block_size)
+{
+	const SerdSink write_func = writer->byte_sink.sink;
+	void* const    stream     = writer->byte_sink.stream;
+	if (!block_size) {
+		block_size = ((write_func == serd_file_sink)
+		              ? serd_file_page_size((FILE*)stream, false)
+		              : SERD_PAGE_SIZE);
+	}
+
+	serd_byte_sink_free(&writer->byte_sink);
+
+	const uint64_t sink_ns = writer->byte_sink.sink_ns;
+	const bool     timed   = writer->byte_sink.timed;
+	writer->byte_sink         = serd_byte_sink_new(
+		write_func, stream, block_size);
+	writer->byte_sink.sink_ns = sink_ns;
+	writer->byte_sink.timed   = timed;
+	if (writer->write_behind) {
+		serd_byte_sink_start_write_behind(&writer->byte_sink,
+		                                  writer->write_behind);
+	}
+}
+
+void
+serd_writer_set_write_behind(SerdWriter* writer, unsigned n_blocks)
+{
+	writer->write_behind = n_blocks;
+	serd_writer_set_block_size(writer, writer->byte_sink.block_size);
+}
+
+SerdWriterStats
+serd_writer_get_stats(const SerdWriter* writer)
+{
+	const SerdWriterStats stats = {
+		writer->n_bytes,
+		writer->n_statements,
+		(double)writer->byte_sink.sink_ns * 1e-9
+	};
+
+	return stats;
+}
+
+void
+serd_writer_set_sink_timing(SerdWriter* writer, bool timed)
+{
+	writer->byte_sink.timed = timed;
+}
+
 void
 serd_writer_chop_blank_prefix(SerdWriter*    writer,
                               const uint8_t* prefix)
@@ -25,6 +25,7 @@
 #include <string.h>
 
 #include "serd/serd.h"
+#include "serd_config.h"
 
 #define USTR(s) ((const uint8_t*)(s))
 
@@ -58,6 +59,13 @@ count_prefixes(void* handle, const SerdNode* name, const SerdNode* uri)
 	return SERD_SUCCESS;
 }
 
+static void
+count_progress(void* handle, const SerdReaderStats* stats)
+{
+	assert(stats->n_statements % 10000 == 0);
+	++*(int*)handle;
+}
+
 typedef struct {
 	int             n_statements;
 	const SerdNode* graph;
@@ -86,6 +94,330 @@ test_sink(void*              handle,
 	return SERD_SUCCESS;
 }
 
+typedef struct {
+	char ids[40][8];
+	int  n_ids;
+} BlankTest;
+
+static SerdStatus
+blank_sink(void*              handle,
+           SerdStatementFlags flags,
+           const SerdNode*    graph,
+           const SerdNode*    subject,
+           const SerdNode*    predicate,
+           const SerdNode*    object,
+           const SerdNode*    object_datatype,
+           const SerdNode*    object_lang)
+{
+	(void)flags;
+	(void)graph;
+	(void)subject;
+	(void)predicate;
+	(void)object_datatype;
+	(void)object_lang;
+
+	BlankTest* const bt = (BlankTest*)handle;
+	assert(object->n_bytes < sizeof(bt->ids[0]) && bt->n_ids < 40);
+	memcpy(bt->ids[bt->n_ids++], object->buf, object->n_bytes + 1);
+	return SERD_SUCCESS;
+}
+
+typedef struct {
+	const uint8_t* input;
+	size_t         input_len;
+	int            n_views;
+} ViewTest;
+
+static bool
+is_view(const ViewTest* vt, const SerdNode* node)
+{
+	return node->buf >= vt->input && node->buf < vt->input + vt->input_len;
+}
+
+static SerdStatus
+view_sink(void*              handle,
+          SerdStatementFlags flags,
+          const SerdNode*    graph,
+          const SerdNode*    subject,
+          const SerdNode*    predicate,
+          const SerdNode*    object,
+          const SerdNode*    object_datatype,
+          const SerdNode*    object_lang)
+{
+	(void)flags;
+	(void)graph;
+	(void)object_datatype;
+	(void)object_lang;
+
+	ViewTest* vt = (ViewTest*)handle;
+	assert(is_view(vt, subject) && subject->n_bytes == 5 &&
+	       !strncmp((const char*)subject->buf, "eg:s1", 5));
+	assert(is_view(vt, predicate) && predicate->n_bytes == 12 &&
+	       !strncmp((const char*)predicate->buf, "http://eg/p1", 12));
+
+	if (is_view(vt, object)) {
+		++vt->n_views;
+		assert(object->n_bytes == object->n_chars);
+	} else {
+		assert(!strcmp((const char*)object->buf, "a\tb"));
+	}
+	return SERD_SUCCESS;
+}
+
+typedef struct {
+	ViewTest view;
+	SerdNode names[4];
+	char     bufs[4][32];
+	int      n_names;
+} NameTest;
+
+static SerdStatus
+name_sink(void*              handle,
+          SerdStatementFlags flags,
+          const SerdNode*    graph,
+          const SerdNode*    subject,
+          const SerdNode*    predicate,
+          const SerdNode*    object,
+          const SerdNode*    object_datatype,
+          const SerdNode*    object_lang)
+{
+	(void)flags;
+	(void)graph;
+	(void)subject;
+	(void)predicate;
+	(void)object_datatype;
+	(void)object_lang;
+
+	NameTest* const nt = (NameTest*)handle;
+	assert(nt->n_names < 4 && object->n_bytes < sizeof(nt->bufs[0]));
+	nt->view.n_views += is_view(&nt->view, object);
+	nt->names[nt->n_names] = *object;
+	memcpy(nt->bufs[nt->n_names++], object->buf, object->n_bytes);
+	return SERD_SUCCESS;
+}
+
+typedef struct {
+	const char* expected;
+	int         n_statements;
+} LiteralTest;
+
+static SerdStatus
+literal_sink(void*              handle,
+             SerdStatementFlags flags,
+             const SerdNode*    graph,
+             const SerdNode*    subject,
+             const SerdNode*    predicate,
+             const SerdNode*    object,
+             const SerdNode*    object_datatype,
+             const SerdNode*    object_lang)
+{
+	(void)flags;
+	(void)graph;
+	(void)subject;
+	(void)predicate;
+	(void)object_datatype;
+	(void)object_lang;
+
+	LiteralTest* lt = (LiteralTest*)handle;
+	++lt->n_statements;
+	assert(object->n_bytes == strlen(lt->expected));
+	assert(!strcmp((const char*)object->buf, lt->expected));
+	return SERD_SUCCESS;
+}
+
+typedef struct {
+	const char* subject;
+	const char* objects[3];
+	const char* lang;
+	int         n_statements;
+} TokenTest;
+
+static SerdStatus
+token_sink(void*              handle,
+           SerdStatementFlags flags,
+           const SerdNode*    graph,
+           const SerdNode*    subject,
+           const SerdNode*    predicate,
+           const SerdNode*    object,
+           const SerdNode*    object_datatype,
+           const SerdNode*    object_lang)
+{
+	(void)flags;
+	(void)graph;
+	(void)predicate;
+	(void)object_datatype;
+
+	TokenTest* const tt       = (TokenTest*)handle;
+	const char*      expected = tt->objects[tt->n_statements++ % 3];
+	assert(subject->n_bytes == strlen(tt->subject));
+	assert(!strcmp((const char*)subject->buf, tt->subject));
+	assert(object->n_bytes == strlen(expected));
+	assert(!strcmp((const char*)object->buf, expected));
+	if (object_lang) {
+		assert(object_lang->n_bytes == strlen(tt->lang));
+		assert(!strcmp((const char*)object_lang->buf, tt->lang));
+	}
+	return SERD_SUCCESS;
+}
+
+typedef struct {
+	int n_statements;
+	int n_blanks;
+} ParallelTest;
+
+static SerdStatus
+parallel_sink(void*              handle,
+              SerdStatementFlags flags,
+              const SerdNode*    graph,
+              const SerdNode*    subject,
+              const SerdNode*    predicate,
+              const SerdNode*    object,
+              const SerdNode*    object_datatype,
+              const SerdNode*    object_lang)
+{
+	(void)flags;
+	(void)graph;
+	(void)predicate;
+	(void)object_datatype;
+	(void)object_lang;
+
+	// Statements must arrive in order, with blank IDs as if read in sequence
+	ParallelTest* pt = (ParallelTest*)handle;
+	char          buf[32];
+	snprintf(buf, sizeof(buf), "%d", pt->n_statements++);
+	assert(!strcmp((const char*)object->buf, buf));
+	if (subject->type == SERD_BLANK) {
+		snprintf(buf, sizeof(buf), "b%d", ++pt->n_blanks);
+		assert(!strcmp((const char*)subject->buf, buf));
+	}
+	return SERD_SUCCESS;
+}
+
+typedef struct {
+	char* seen;          // Shared, whether each object was passed on
+	int*  blanks;        // Shared, blank subject ID of each object
+	int   n_statements;  // Statements passed to this thread's sink
+	int   fail_at;       // Object to fail at, or -1
+} ThreadTest;
+
+static SerdStatus
+thread_sink(void*              handle,
+            SerdStatementFlags flags,
+            const SerdNode*    graph,
+            const SerdNode*    subject,
+            const SerdNode*    predicate,
+            const SerdNode*    object,
+            const SerdNode*    object_datatype,
+            const SerdNode*    object_lang)
+{
+	(void)flags;
+	(void)graph;
+	(void)predicate;
+	(void)object_datatype;
+	(void)object_lang;
+
+	// Each statement is passed once, to one thread, so nothing is shared
+	ThreadTest* const tt = (ThreadTest*)handle;
+	const int         n  = atoi((const char*)object->buf);
+	if (n == tt->fail_at) {
+		return SERD_ERR_UNKNOWN;
+	}
+
+	assert(!tt->seen[n]);
+	tt->seen[n] = 1;
+	++tt->n_statements;
+	if (subject->type == SERD_BLANK) {
+		tt->blanks[n] = atoi((const char*)subject->buf + 1);
+	}
+	return SERD_SUCCESS;
+}
+
+static SerdStatus
+batch_sink(void*                handle,
+           const SerdStatement* statements,
+           size_t               n_statements)
+{
+	assert(n_statements > 0 && n_statements <= 100);
+	for (size_t i = 0; i < n_statements; ++i) {
+		const SerdStatement* const s = &statements[i];
+		parallel_sink(handle, s->flags, s->graph, s->subject, s->predicate,
+		              s->object, s->object_datatype, s->object_lang);
+	}
+	return SERD_SUCCESS;
+}
+
+static SerdStatus
+failing_batch_sink(void*                handle,
+                   const SerdStatement* statements,
+                   size_t               n_statements)
+{
+	(void)handle;
+	(void)statements;
+	(void)n_statements;
+
+	return SERD_ERR_BAD_ARG;
+}
+
+static SerdStatus
+count_base(void* handle, const SerdNode* uri)
+{
+	(void)uri;
+
+	++*(int*)handle;
+	return SERD_SUCCESS;
+}
+
+static SerdStatus
+count_end(void* handle, const SerdNode* node)
+{
+	(void)node;
+
+	++*(int*)handle;
+	return SERD_SUCCESS;
+}
+
+typedef struct {
+	ParallelTest     pt;
+	SerdStatementIds last;    ///< IDs of the last statement
+	SerdTermId       max_id;  ///< Largest ID seen before the last statement
+} IdTest;
+
+static SerdStatus
+id_sink(void*                   handle,
+        const SerdStatement*    statement,
+        const SerdStatementIds* ids)
+{
+	IdTest* const           it = (IdTest*)handle;
+	const SerdStatementIds* l  = &it->last;
+
+	// Equal nodes have equal IDs, and new nodes have larger IDs
+	assert(!ids->predicate || !l->predicate || ids->predicate == l->predicate);
+	assert(ids->object > it->max_id && ids->object > ids->subject);
+	assert(!ids->graph == !statement->graph);
+	assert(!ids->object_datatype == !statement->object_datatype);
+	assert(!ids->object_lang == !statement->object_lang);
+
+	const SerdTermId all[] = { ids->graph, ids->subject, ids->predicate,
+	                           ids->object, ids->object_datatype,
+	                           ids->object_lang };
+	for (unsigned i = 0; i < 6; ++i) {
+		it->max_id = all[i] > it->max_id ? all[i] : it->max_id;
+	}
+
+	it->last = *ids;
+	return parallel_sink(&it->pt, statement->flags, statement->graph,
+	                     statement->subject, statement->predicate,
+	                     statement->object, statement->object_datatype,
+	                     statement->object_lang);
+}
+
+static SerdStatus
+quiet_error_sink(void* handle, const SerdError* e)
+{
+	*(SerdError*)handle = *e;
+	return SERD_SUCCESS;
+}
+
 static void
 test_file_uri(const char* hostname,
               const char* path,
@@ -473,6 +805,7 @@ main(void)
 	o = serd_node_from_string(SERD_LITERAL, USTR("hello"));
 	assert(!serd_writer_write_statement(writer, 0, NULL,
 	                                    &s, &p, &o, NULL, NULL));
+	assert(serd_writer_get_stats(writer).n_statements == 13);
 
 	serd_writer_free(writer);
 
@@ -490,6 +823,40 @@ main(void)
 	assert(!strcmp((const char*)out, "@base <http://example.org/base> .\n"));
 	serd_free(out);
 
+	// Test writing to a chunk sink in blocks smaller than the output
+	chunk.buf = NULL;
+	chunk.len = 0;
+	writer    = serd_writer_new(
+		SERD_TURTLE, (SerdStyle)0, env, NULL, serd_chunk_sink, &chunk);
+
+	serd_writer_set_block_size(writer, 7);
+	serd_writer_set_sink_timing(writer, true);
+	assert(!serd_writer_set_base_uri(writer, &o));
+	assert(serd_writer_get_stats(writer).n_bytes == 34);
+
+	serd_writer_free(writer);
+	out = serd_chunk_sink_finish(&chunk);
+
+	assert(!strcmp((const char*)out, "@base <http://example.org/base> .\n"));
+	serd_free(out);
+
+	// Test writing blocks to a file behind the writer
+	FILE* const behind_fd = tmpfile();
+	writer                = serd_writer_new(
+		SERD_TURTLE, SERD_STYLE_BULK, env, NULL, serd_file_sink, behind_fd);
+
+	serd_writer_set_block_size(writer, 7);
+	serd_writer_set_write_behind(writer, 3);
+	assert(!serd_writer_set_base_uri(writer, &o));
+
+	serd_writer_free(writer);
+
+	char behind_out[64] = { 0 };
+	fseek(behind_fd, 0, SEEK_SET);
+	assert(fread(behind_out, 1, sizeof(behind_out) - 1, behind_fd) == 34);
+	assert(!strcmp(behind_out, "@base <http://example.org/base> .\n"));
+	fclose(behind_fd);
+
 	// Rewind and test reader
 	fseek(fd, 0, SEEK_SET);
 
@@ -520,6 +887,684 @@ main(void)
 	serd_reader_free(reader);
 	fclose(fd);
 
+	// Test generated blank IDs in decimal and base 36
+	char blank_doc[256] = "<http://eg/s> <http://eg/p> _:b1";
+	for (int i = 0; i < 38; ++i) {
+		strcat(blank_doc, " , []");
+	}
+	strcat(blank_doc, " .");
+
+	BlankTest bt = { { { 0 } }, 0 };
+	reader = serd_reader_new(
+		SERD_TURTLE, &bt, NULL, NULL, NULL, blank_sink, NULL);
+	assert(serd_reader_set_blank_id_radix(reader, 16) == SERD_ERR_BAD_ARG);
+	assert(!serd_reader_read_string(reader, USTR(blank_doc)));
+	assert(!strcmp(bt.ids[0], "B1") && !strcmp(bt.ids[1], "b1"));
+	assert(!strcmp(bt.ids[10], "b10") && !strcmp(bt.ids[38], "b38"));
+
+	bt.n_ids = 0;
+	serd_reader_free(reader);
+	reader = serd_reader_new(
+		SERD_TURTLE, &bt, NULL, NULL, NULL, blank_sink, NULL);
+	assert(!serd_reader_set_blank_id_radix(reader, 36));
+	assert(!serd_reader_read_string(reader, USTR(blank_doc)));
+	assert(!strcmp(bt.ids[0], "B1") && !strcmp(bt.ids[9], "b9"));
+	assert(!strcmp(bt.ids[10], "b0a") && !strcmp(bt.ids[35], "b0z"));
+	assert(!strcmp(bt.ids[36], "b10") && !strcmp(bt.ids[38], "b12"));
+	serd_reader_free(reader);
+
+	// Test reading nodes as views into the input
+	const char* const view_doc =
+		"@prefix eg: <http://eg/> .\n"
+		"eg:s1 <http://eg/p1> \"hello\" , 'a\\tb' , \"\"\"world\"\"\" ,"
+		" _:node1 , eg:lname .";
+
+	ViewTest vt = { USTR(view_doc), strlen(view_doc), 0 };
+	reader = serd_reader_new(
+		SERD_TURTLE, &vt, NULL, NULL, NULL, view_sink, NULL);
+	serd_reader_set_node_views(reader, true);
+	assert(!serd_reader_read_string(reader, USTR(view_doc)));
+	assert(vt.n_views == 4);
+	serd_reader_free(reader);
+
+	// Test reading non-ASCII names as views like copies
+	const char* const name_doc =
+		"@prefix \xC3\xA9: <http://eg/> .\n"
+		"<http://eg/s> <http://eg/p> \xC3\xA9:\xD0\xB6\xC2\xB7\xE4\xB8\xAD , "
+		"\xC3\xA9:a.\xCC\x81" "b , _:\xCE\xA9\xE2\x80\xBF" "a , "
+		"\xC3\xA9:\xC2\xB7 .";
+
+	NameTest copies = { { USTR(name_doc), strlen(name_doc), 0 }, { { 0 } },
+	                    { { 0 } }, 0 };
+	NameTest views  = copies;
+	for (int i = 0; i < 2; ++i) {
+		NameTest* const nt = i ? &views : &copies;
+		reader = serd_reader_new(
+			SERD_TURTLE, nt, NULL, NULL, NULL, name_sink, NULL);
+		serd_reader_set_node_views(reader, i);
+		serd_reader_set_strict(reader, false);
+		assert(!serd_reader_read_string(reader, USTR(name_doc)));
+		assert(nt->n_names == 4);
+		serd_reader_free(reader);
+	}
+
+	assert(copies.view.n_views == 0 && views.view.n_views == 3);
+	for (int i = 0; i < 4; ++i) {
+		const SerdNode* const copy = &copies.names[i];
+		const SerdNode* const view = &views.names[i];
+		assert(copy->type == view->type && copy->n_bytes == view->n_bytes &&
+		       copy->n_chars == view->n_chars && copy->flags == view->flags);
+		assert(!memcmp(copies.bufs[i], views.bufs[i], copy->n_bytes));
+	}
+
+	// Test reading UTF-8 literals and IRIs as views like copies
+	const char* const utf8_doc =
+		"<http://eg/s> <http://eg/p> "
+		"\"\xD0\x9F\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82, "
+		"\xD0\xBC\xD0\xB8\xD1\x80\" , "
+		"\"\"\"\xE4\xB8\xAD\xE6\x96\x87\n\xE5\xAD\x97\xE7\xAC\xA6\"\"\" , "
+		"<http://eg/\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E> , "
+		"\"a\xED\xA0\x80" "b\" .";
+
+	NameTest utf8_copies = { { USTR(utf8_doc), strlen(utf8_doc), 0 },
+	                         { { 0 } }, { { 0 } }, 0 };
+	NameTest utf8_views  = utf8_copies;
+	for (int i = 0; i < 2; ++i) {
+		NameTest* const nt = i ? &utf8_views : &utf8_copies;
+		reader = serd_reader_new(
+			SERD_TURTLE, nt, NULL, NULL, NULL, name_sink, NULL);
+		serd_reader_set_node_views(reader, i);
+		serd_reader_set_strict(reader, false);
+		assert(!serd_reader_read_string(reader, USTR(utf8_doc)));
+		assert(nt->n_names == 4);
+		serd_reader_free(reader);
+	}
+
+	assert(utf8_copies.view.n_views == 0 && utf8_views.view.n_views == 4);
+	for (int i = 0; i < 4; ++i) {
+		const SerdNode* const copy = &utf8_copies.names[i];
+		const SerdNode* const view = &utf8_views.names[i];
+		assert(copy->type == view->type && copy->n_bytes == view->n_bytes &&
+		       copy->n_chars == view->n_chars && copy->flags == view->flags);
+		assert(!memcmp(utf8_copies.bufs[i], utf8_views.bufs[i], copy->n_bytes));
+	}
+
+	// Test reading escaped and simple NQuads lines one statement at a time
+	const char* const nq_doc =
+		"<http://eg/s> <http://eg/p> \"a\\tb\" <http://eg/g> .\n"
+		"<http://eg/s> <http://eg/p> \"a\tb\"@en _:g .\n";
+
+	LiteralTest nqt = { "a\tb", 0 };
+	reader = serd_reader_new(
+		SERD_NQUADS, &nqt, NULL, NULL, NULL, literal_sink, NULL);
+	FILE* const nq_fd = tmpfile();
+	fputs(nq_doc, nq_fd);
+	fseek(nq_fd, 0, SEEK_SET);
+	assert(!serd_reader_start_stream(reader, nq_fd, USTR("test"), true));
+	assert(!serd_reader_read_chunk(reader));
+	assert(!serd_reader_read_chunk(reader));
+	assert(nqt.n_statements == 2);
+	assert(!serd_reader_end_stream(reader));
+	fclose(nq_fd);
+	serd_reader_free(reader);
+
+	// Test reading a long literal with plain runs across page boundaries
+	static char lit_doc[16384];
+	static char lit_expected[16384];
+	strcpy(lit_doc, "<http://eg/s> <http://eg/p> \"\"\"");
+	for (int i = 0; i < 8; ++i) {
+		char run[1001];
+		memset(run, 'a' + i, 1000);
+		run[1000] = '\0';
+		strcat(lit_doc, run);
+		strcat(lit_doc, "\\t\"\xC3\xA9\n");
+		strcat(lit_expected, run);
+		strcat(lit_expected, "\t\"\xC3\xA9\n");
+	}
+	strcat(lit_doc, "\"\"\" .\n");
+
+	LiteralTest lt = { lit_expected, 0 };
+	reader = serd_reader_new(
+		SERD_TURTLE, &lt, NULL, NULL, NULL, literal_sink, NULL);
+	assert(!serd_reader_read_string(reader, USTR(lit_doc)));
+	assert(lt.n_statements == 1);
+
+	FILE* const lit_fd = tmpfile();
+	fputs(lit_doc, lit_fd);
+	fseek(lit_fd, 0, SEEK_SET);
+	assert(!serd_reader_read_source(reader,
+	                                (SerdSource)fread,
+	                                (SerdStreamErrorFunc)ferror,
+	                                lit_fd,
+	                                USTR("test"),
+	                                4096));
+	assert(lt.n_statements == 2);
+
+	// Test reading the same source with pages read ahead in a thread
+	fseek(lit_fd, 0, SEEK_SET);
+	serd_reader_set_read_ahead(reader, 3);
+	assert(!serd_reader_read_source(reader,
+	                                (SerdSource)fread,
+	                                (SerdStreamErrorFunc)ferror,
+	                                lit_fd,
+	                                USTR("test"),
+	                                4096));
+	assert(lt.n_statements == 3);
+
+	// Test reading the same stream in an automatically sized page
+	fseek(lit_fd, 0, SEEK_SET);
+	serd_reader_set_read_ahead(reader, 0);
+	serd_reader_set_page_size(reader, 0);
+	assert(!serd_reader_start_stream(reader, lit_fd, USTR("test"), true));
+	while (!serd_reader_read_chunk(reader)) {}
+	assert(!serd_reader_end_stream(reader));
+	assert(lt.n_statements == 4);
+	fclose(lit_fd);
+
+	// Test reading with a small stack that is trimmed after every statement
+	serd_reader_set_stack_policy(reader, 64, 2.0, 1024);
+	assert(!serd_reader_read_string(reader, USTR(lit_doc)));
+	assert(lt.n_statements == 5);
+	assert(serd_reader_get_stack_peak(reader) > strlen(lit_expected));
+	serd_reader_free(reader);
+
+	// Test reading long names, numbers, and language tags in bulk runs
+	static char tok_name[4096];
+	static char tok_label[4096];
+	static char tok_number[4096];
+	static char tok_lang[4096];
+	static char tok_doc[20480];
+	strcpy(tok_name, "eg:");
+	strcpy(tok_lang, "en-");
+	for (int i = 0; i < 300; ++i) {
+		strcat(tok_name, i % 2 ? "ab.c:d-e_0" : "f.g%41hi:j");
+		strcat(tok_label, "xy.z-0_9.w");
+		strcat(tok_number, "1234567890");
+		strcat(tok_lang, "abcDE01234");
+	}
+	snprintf(tok_doc,
+	         sizeof(tok_doc),
+	         "@prefix eg: <http://eg/> .\n"
+	         "%s eg:p _:%s ;\n eg:q %s ;\n eg:r \"x\"@%s .\n",
+	         tok_name,
+	         tok_label,
+	         tok_number,
+	         tok_lang);
+
+	TokenTest tt = { tok_name, { tok_label, tok_number, "x" }, tok_lang, 0 };
+	reader = serd_reader_new(
+		SERD_TURTLE, &tt, NULL, NULL, NULL, token_sink, NULL);
+	serd_reader_set_stack_policy(reader, 64, 2.0, 0);
+	assert(!serd_reader_read_string(reader, USTR(tok_doc)));
+	assert(tt.n_statements == 3);
+
+	// Test the same tokens split across small pages and read a byte at a time
+	FILE* const tok_fd = tmpfile();
+	fputs(tok_doc, tok_fd);
+	const size_t tok_page_sizes[] = { 17, 64 };
+	for (size_t i = 0; i < sizeof(tok_page_sizes) / sizeof(size_t); ++i) {
+		fseek(tok_fd, 0, SEEK_SET);
+		assert(!serd_reader_read_source(reader,
+		                                (SerdSource)fread,
+		                                (SerdStreamErrorFunc)ferror,
+		                                tok_fd,
+		                                USTR("test"),
+		                                tok_page_sizes[i]));
+		assert(tt.n_statements == 3 * (int)(i + 2));
+	}
+	fseek(tok_fd, 0, SEEK_SET);
+	assert(!serd_reader_start_stream(reader, tok_fd, USTR("test"), false));
+	while (!serd_reader_read_chunk(reader)) {}
+	assert(!serd_reader_end_stream(reader));
+	assert(tt.n_statements == 12);
+	fclose(tok_fd);
+	assert(serd_reader_get_stack_peak(reader) >
+	       strlen(tok_name) + strlen(tok_lang));
+	serd_reader_free(reader);
+
+	// Test streams that start like compressed input, which must be put back
+	static const char* const magic_docs[] = {
+		"(\t1 ) <http://eg/p> 2 .\n",
+		"@prefix BZh1: <http://eg/> .\nBZh1:s BZh1:p 1 .\n"
+	};
+	for (unsigned i = 0; i < 4; ++i) {
+		FILE* const magic_fd = tmpfile();
+		fputs(magic_docs[i / 2], magic_fd);
+		fseek(magic_fd, 0, SEEK_SET);
+
+		ReaderTest magic_rt = { 0, NULL };
+		reader              = serd_reader_new(
+			SERD_TURTLE, &magic_rt, NULL, NULL, NULL, test_sink, NULL);
+		assert(!serd_reader_start_stream(reader, magic_fd, NULL, i % 2));
+		while (!serd_reader_read_chunk(reader)) {}
+		assert(!serd_reader_end_stream(reader));
+		assert(magic_rt.n_statements == (i / 2 ? 1 : 3));
+		serd_reader_free(reader);
+		fclose(magic_fd);
+	}
+
+	// Test error positions, which are calculated when an error is reported
+	SerdError err = { SERD_SUCCESS, NULL, 0, 0, NULL, NULL };
+	reader = serd_reader_new(SERD_TURTLE, NULL, NULL, NULL, NULL, NULL, NULL);
+	serd_reader_set_error_sink(reader, quiet_error_sink, &err);
+	assert(serd_reader_read_string(reader,
+	                               USTR("# Comment\n"
+	                                    "<http://eg/s> <http://eg/p>\n"
+	                                    "\t\"\"\"o\n\"\"\" ?")));
+	assert(err.status == SERD_ERR_BAD_SYNTAX);
+	assert(err.line == 4 && err.col == 4);
+	serd_reader_free(reader);
+
+	// Test that a GRAPH name which is not an IRI is an error at the name
+	ReaderTest graph_rt = { 0, NULL };
+	reader              = serd_reader_new(
+		SERD_TRIG, &graph_rt, NULL, NULL, NULL, test_sink, NULL);
+	serd_reader_set_strict(reader, true);
+	serd_reader_set_error_sink(reader, quiet_error_sink, &err);
+	assert(serd_reader_read_string(
+		reader,
+		USTR("GRAPH bad { <http://eg/s> <http://eg/p> <http://eg/o> . }\n")));
+	assert(err.status == SERD_ERR_BAD_SYNTAX);
+	assert(err.line == 1 && err.col == 10);
+	assert(!graph_rt.n_statements);
+	serd_reader_free(reader);
+
+	// Test skipping bad statements in lax mode, and only counting errors
+	ReaderTest lax_rt = { 0, NULL };
+	reader            = serd_reader_new(
+		SERD_TURTLE, &lax_rt, NULL, NULL, NULL, test_sink, NULL);
+	serd_reader_set_strict(reader, false);
+	serd_reader_set_error_sink(reader, quiet_error_sink, &err);
+	serd_reader_set_error_limit(reader, 1);
+	assert(!serd_reader_read_string(reader,
+	                                USTR("<http://eg/s> <http://eg/p> bad .\n"
+	                                     "<http://eg/s> <http://eg/p> [\n"
+	                                     "  <http://eg/q> bad\n"
+	                                     "] .\n"
+	                                     "<http://eg/s> <http://eg/p> 1 .\n")));
+	assert(lax_rt.n_statements == 2);
+	assert(err.line == 1);
+	assert(serd_reader_get_error_count(reader, SERD_ERR_BAD_SYNTAX) == 2);
+
+	// Test that only the line is skipped after an error at a statement's end
+	uint64_t n_before = serd_reader_get_error_count(reader, SERD_ERR_BAD_SYNTAX);
+	assert(!serd_reader_read_string(reader,
+	                                USTR("@prefix : <http://eg/> .\n"
+	                                     ":a.:b.:c .\n"
+	                                     ":s . :p 1.\n"
+	                                     ":s :p :o .\n")));
+	assert(lax_rt.n_statements == 3);
+	assert(serd_reader_get_error_count(reader, SERD_ERR_BAD_SYNTAX) ==
+	       n_before + 2);
+
+	// Test that a '.' or quote in a string or IRI does not end skipping
+	n_before = serd_reader_get_error_count(reader, SERD_ERR_BAD_SYNTAX);
+	assert(!serd_reader_read_string(reader,
+	                                USTR("<http://eg/s> <http://eg/p> \"\"\"\\q\n"
+	                                     "  ends.\n"
+	                                     "\"\"\" .\n"
+	                                     "<http://eg/s> <http://eg/a{\"> ;\n"
+	                                     "  <http://eg/p> \"x.\" .\n"
+	                                     "<http://eg/s> <http://eg/p> \"o\n"
+	                                     "<http://eg/s> <http://eg/p> 1 .\n")));
+	assert(lax_rt.n_statements == 4);
+	assert(serd_reader_get_error_count(reader, SERD_ERR_BAD_SYNTAX) ==
+	       n_before + 3);
+
+	// Test validating, which counts statements but does not pass them on
+	const SerdReaderStats lax_stats = serd_reader_get_stats(reader);
+	serd_reader_set_validate_only(reader, true);
+	assert(!serd_reader_read_string(reader,
+	                                USTR("@prefix eg: <http://eg/> .\n"
+	                                     "eg:s eg:p [ eg:q 1 ] .\n"
+	                                     "eg:s bad:p eg:o .\n"
+	                                     "eg:s eg:p \"\\u00E9\" .\n")));
+	assert(lax_rt.n_statements == 4);
+	assert(serd_reader_get_stats(reader).n_statements ==
+	       lax_stats.n_statements + 3);
+	assert(serd_reader_get_error_count(reader, SERD_ERR_BAD_CURIE) == 1);
+	serd_reader_free(reader);
+
+	// Test skipping a graph with an error to its end, not to a line inside it
+	lax_rt.n_statements = 0;
+	reader              = serd_reader_new(
+		SERD_TRIG, &lax_rt, NULL, NULL, NULL, test_sink, NULL);
+	serd_reader_set_strict(reader, false);
+	serd_reader_set_error_sink(reader, quiet_error_sink, &err);
+	assert(!serd_reader_read_string(reader,
+	                                USTR("<http://eg/g> {\n"
+	                                     "  <http://eg/s> bad .\n"
+	                                     "  [ <http://eg/p> <http://eg/o> ] .\n"
+	                                     "}\n"
+	                                     "<http://eg/s> <http://eg/p> 1 .\n")));
+	assert(lax_rt.n_statements == 1 && !lax_rt.graph);
+
+	// Test that validating catches a bad graph name too
+	serd_reader_set_strict(reader, true);
+	serd_reader_set_validate_only(reader, true);
+	assert(serd_reader_read_string(reader, USTR("GRAPH { <http://eg/s> "
+	                                            "<http://eg/p> 1 }\n")));
+	assert(err.line == 1 && err.col == 7);
+	serd_reader_free(reader);
+
+	// Test that lax NQuads still stops at the first bad line
+	lax_rt.n_statements = 0;
+	reader              = serd_reader_new(
+		SERD_NQUADS, &lax_rt, NULL, NULL, NULL, test_sink, NULL);
+	serd_reader_set_strict(reader, false);
+	serd_reader_set_error_sink(reader, quiet_error_sink, &err);
+	assert(serd_reader_read_string(
+		reader,
+		USTR("<http://eg/s> <http://eg/p> <http://eg/o> <http://eg/g> .\n"
+		     "<http://eg/s> <http://eg/p> bad <http://eg/g> .\n"
+		     "<http://eg/s> <http://eg/p> <http://eg/o> .\n")));
+	assert(lax_rt.n_statements == 1);
+	assert(serd_reader_get_error_count(reader, SERD_ERR_BAD_SYNTAX) == 1);
+	serd_reader_free(reader);
+
+	// Test feeding a document a byte at a time, split inside every token
+	const char* const feed_doc =
+		"@prefix eg: <http://eg/> .\n"
+		"eg:s eg:p \"\"\"long.\n\"\"\" , 'a.\\' b' ; # comment.\n"
+		"  eg:q [ eg:r 1.5 ] .\n"
+		"eg:s eg:p eg:o";
+
+	ReaderTest frt = { 0, NULL };
+	reader = serd_reader_new(
+		SERD_TURTLE, &frt, NULL, NULL, NULL, test_sink, NULL);
+	serd_reader_set_error_sink(reader, quiet_error_sink, &err);
+	for (const char* f = feed_doc; *f; ++f) {
+		assert(!serd_reader_feed(reader, USTR(f), 1));
+	}
+	assert(frt.n_statements == 4);
+	assert(serd_reader_finish(reader) == SERD_ERR_UNKNOWN);
+	assert(err.status == SERD_ERR_BAD_SYNTAX && err.line == 5);
+	assert(frt.n_statements == 5);
+
+	// Test that reading stops at an error, until the reader is finished
+	const size_t feed_len = strlen(feed_doc);
+	assert(!serd_reader_feed(reader, USTR("<http://eg/s> .\n"), 16));
+	assert(serd_reader_feed(reader, USTR(feed_doc), feed_len));
+	assert(serd_reader_feed(reader, USTR(feed_doc), feed_len));
+	assert(serd_reader_finish(reader));
+	assert(!serd_reader_feed(reader, USTR(feed_doc), feed_len));
+	assert(frt.n_statements == 9);
+	serd_reader_free(reader);
+
+	// Test resuming from a checkpoint with a new reader
+	const char* const cp_doc =
+		"@prefix eg: <http://eg/> .\n"
+		"eg:s eg:p [] .\n"
+		"eg:s eg:p [] .\n"
+		"eg:s eg:p [] .\n"
+		"eg:s eg:p .\n";
+
+	FILE* const cp_fd = tmpfile();
+	fprintf(cp_fd, "%s", cp_doc);
+	fseek(cp_fd, 0, SEEK_SET);
+
+	BlankTest cbt = { { { 0 } }, 0 };
+	reader = serd_reader_new(
+		SERD_TURTLE, &cbt, NULL, NULL, NULL, blank_sink, NULL);
+	serd_reader_start_stream(reader, cp_fd, USTR("test"), true);
+	assert(!serd_reader_read_chunk(reader));
+	assert(!serd_reader_read_chunk(reader));
+	serd_reader_end_stream(reader);
+
+	SerdCheckpoint cp = serd_reader_get_checkpoint(reader);
+	assert(cp.offset == 41 && cp.line == 2 && cp.next_id == 2);
+	assert(!strcmp((const char*)cp.env.buf, "@prefix eg: <http://eg/> .\n"));
+	serd_reader_free(reader);
+
+	int n_cp_prefixes = 0;
+	reader = serd_reader_new(
+		SERD_TURTLE, &n_cp_prefixes, NULL, NULL, count_prefixes, NULL, NULL);
+	assert(!serd_reader_resume(reader, &cp));
+	assert(n_cp_prefixes == 1);
+	serd_reader_free(reader);
+
+	reader = serd_reader_new(
+		SERD_TURTLE, &cbt, NULL, NULL, NULL, blank_sink, NULL);
+	serd_reader_set_error_sink(reader, quiet_error_sink, &err);
+	assert(!serd_reader_resume(reader, &cp));
+	fseek(cp_fd, (long)cp.offset, SEEK_SET);
+	assert(serd_reader_read_file_handle(reader, cp_fd, USTR("test")));
+	assert(err.status == SERD_ERR_BAD_SYNTAX && err.line == 5);
+	assert(cbt.n_ids == 3 && !strcmp(cbt.ids[2], "b3"));
+	serd_node_free(&cp.env);
+	serd_reader_free(reader);
+	fclose(cp_fd);
+
+	// Test that checkpoints have directives in effect, in order, after many
+	static char env_doc[131072];
+	size_t      env_len = (size_t)snprintf(env_doc,
+	                                       sizeof(env_doc),
+	                                       "@base <http://eg/> .\n"
+	                                       "@prefix a: <a/> .\n"
+	                                       "@base <sub/> .\n"
+	                                       "@prefix a: <c/> .\n");
+	for (int i = 0; i < 2000; ++i) {
+		env_len += (size_t)snprintf(env_doc + env_len,
+		                            sizeof(env_doc) - env_len,
+		                            "@prefix p%d: <p/> .\n<s> a: p%d:o .\n",
+		                            i,
+		                            i);
+	}
+	assert(env_len < sizeof(env_doc));
+
+	reader = serd_reader_new(SERD_TURTLE, NULL, NULL, NULL, NULL, NULL, NULL);
+	assert(!serd_reader_read_string(reader, USTR(env_doc)));
+	cp = serd_reader_get_checkpoint(reader);
+	assert(!strncmp((const char*)cp.env.buf,
+	                "@base <http://eg/sub/> .\n"
+	                "@prefix a: <http://eg/sub/c/> .\n"
+	                "@prefix p0: <http://eg/sub/p/> .\n",
+	                90));
+	serd_reader_free(reader);
+
+	n_cp_prefixes = 0;
+	reader = serd_reader_new(
+		SERD_TURTLE, &n_cp_prefixes, NULL, NULL, count_prefixes, NULL, NULL);
+	assert(!serd_reader_resume(reader, &cp));
+	assert(n_cp_prefixes == 2001);
+	serd_node_free(&cp.env);
+	serd_reader_free(reader);
+
+	// Test reading NTriples in parallel, with an error in the middle
+	FILE* const par_fd = tmpfile();
+	for (int i = 0, n = 0; i < 40000; ++i) {
+		if (i == 20000) {
+			fprintf(par_fd, "<http://eg/s> <http://eg/p> bad .\n");
+		} else {
+			fprintf(par_fd, "%s <http://eg/p> \"%d\" .\n",
+			        i % 1000 ? "<http://eg/s>" : "[]", n++);
+		}
+	}
+	const long par_size = ftell(par_fd);
+	fseek(par_fd, 0, SEEK_SET);
+
+	ParallelTest pt         = { 0, 0 };
+	int          n_progress = 0;
+	reader = serd_reader_new(
+		SERD_NTRIPLES, &pt, NULL, NULL, NULL, parallel_sink, NULL);
+	serd_reader_set_strict(reader, false);
+	serd_reader_set_error_sink(reader, quiet_error_sink, &err);
+	serd_reader_set_progress_sink(reader, count_progress, &n_progress, 10000);
+	assert(!serd_reader_read_file_parallel(reader, par_fd, USTR("test"), 4));
+	assert(pt.n_statements == 39999 && pt.n_blanks == 39);
+	assert(err.status == SERD_ERR_BAD_SYNTAX && err.line == 20001);
+	assert(n_progress == 3);
+
+	const SerdReaderStats par_stats = serd_reader_get_stats(reader);
+	assert(par_stats.n_bytes == (uint64_t)par_size);
+	assert(par_stats.n_statements == 39999);
+	assert(par_stats.n_nodes >= 3 * 39999);
+	serd_reader_free(reader);
+
+	// Test reading the same document as Turtle in parallel
+	fseek(par_fd, 0, SEEK_SET);
+	pt.n_statements = pt.n_blanks = 0;
+	err.status      = SERD_SUCCESS;
+	reader          = serd_reader_new(
+		SERD_TURTLE, &pt, NULL, NULL, NULL, parallel_sink, NULL);
+	serd_reader_set_strict(reader, false);
+	serd_reader_set_error_sink(reader, quiet_error_sink, &err);
+	assert(!serd_reader_read_file_parallel(reader, par_fd, USTR("test"), 4));
+	assert(pt.n_statements == 39999 && pt.n_blanks == 39);
+	assert(err.status == SERD_ERR_BAD_SYNTAX && err.line == 20001);
+	serd_reader_free(reader);
+
+	// Test passing statements to a sink for each thread, out of order
+	static char  par_seen[39999];
+	static int   par_blanks[39999];
+	ThreadTest   thread_tests[3];
+	void*        thread_handles[3];
+	for (unsigned i = 0; i < 3; ++i) {
+		const ThreadTest init = { par_seen, par_blanks, 0, -1 };
+		thread_tests[i]       = init;
+		thread_handles[i]     = &thread_tests[i];
+	}
+
+	fseek(par_fd, 0, SEEK_SET);
+	reader = serd_reader_new(
+		SERD_TURTLE, NULL, NULL, NULL, NULL, thread_sink, NULL);
+	serd_reader_set_strict(reader, false);
+	serd_reader_set_error_sink(reader, quiet_error_sink, &err);
+	serd_reader_set_thread_handles(reader, thread_handles, 3);
+	assert(!serd_reader_read_file_parallel(reader, par_fd, USTR("test"), 8));
+	assert(thread_tests[0].n_statements + thread_tests[1].n_statements +
+	       thread_tests[2].n_statements == 39999);
+	assert(serd_reader_get_stats(reader).n_statements == 39999);
+
+	// Blank IDs are the same as in sequence, increasing with the objects
+	for (int n = 0, n_blanks = 0; n < 39999; ++n) {
+		assert(par_seen[n]);
+		assert(!par_blanks[n] || par_blanks[n] == ++n_blanks);
+		assert(n < 39998 || n_blanks == 39);
+	}
+
+	// Test that a failing thread sink stops reading
+	fseek(par_fd, 0, SEEK_SET);
+	memset(par_seen, 0, sizeof(par_seen));
+	for (unsigned i = 0; i < 3; ++i) {
+		thread_tests[i].fail_at = 30000;
+	}
+	assert(serd_reader_read_file_parallel(reader, par_fd, USTR("test"), 8) ==
+	       SERD_ERR_UNKNOWN);
+	serd_reader_free(reader);
+
+	// Test reading the same document in batches, in sequence and in parallel
+	for (unsigned n_threads = 1; n_threads <= 4; n_threads += 3) {
+		fseek(par_fd, 0, SEEK_SET);
+		pt.n_statements = pt.n_blanks = 0;
+		reader = serd_reader_new(
+			SERD_TURTLE, &pt, NULL, NULL, NULL, NULL, NULL);
+		serd_reader_set_statement_batch_sink(reader, batch_sink, 100);
+		serd_reader_set_strict(reader, false);
+		serd_reader_set_error_sink(reader, quiet_error_sink, &err);
+		assert(!serd_reader_read_file_parallel(
+			       reader, par_fd, USTR("test"), n_threads));
+		assert(pt.n_statements == 39999 && pt.n_blanks == 39);
+		serd_reader_free(reader);
+	}
+
+	// Test that a failing batch stops reading before a base or end event
+	int n_events = 0;
+	reader       = serd_reader_new(
+		SERD_TURTLE, &n_events, NULL, count_base, NULL, NULL, count_end);
+	assert(!serd_reader_set_statement_batch_sink(
+		reader, failing_batch_sink, 100));
+	assert(serd_reader_read_string(
+		reader,
+		USTR("<http://eg/s> <http://eg/p> <http://eg/o> .\n"
+		     "@base <http://eg/> .\n")));
+	assert(serd_reader_read_string(
+		reader, USTR("<http://eg/s> <http://eg/p> [ <http://eg/q> 1 ] .\n")));
+	assert(!n_events);
+	serd_reader_free(reader);
+
+	// Test interning nodes with IDs in a small table, in sequence and parallel
+	for (unsigned n_threads = 1; n_threads <= 4; n_threads += 3) {
+		fseek(par_fd, 0, SEEK_SET);
+		IdTest it = { { 0, 0 }, { 0, 0, 0, 0, 0, 0 }, 0 };
+		reader = serd_reader_new(
+			SERD_TURTLE, &it, NULL, NULL, NULL, NULL, NULL);
+		serd_reader_set_statement_id_sink(reader, id_sink, 1);
+		serd_reader_set_strict(reader, false);
+		serd_reader_set_error_sink(reader, quiet_error_sink, &err);
+		assert(!serd_reader_read_file_parallel(
+			       reader, par_fd, USTR("test"), n_threads));
+		assert(it.pt.n_statements == 39999 && it.pt.n_blanks == 39);
+
+		// Every literal and blank is new, and the subject and predicate stay
+		const SerdReaderStats id_stats = serd_reader_get_stats(reader);
+		assert(id_stats.n_term_misses == 39999 + 39 + 2);
+		assert(id_stats.n_term_hits == 3 * 39999 - id_stats.n_term_misses);
+		assert(id_stats.n_term_evictions > 0);
+		assert(it.max_id == id_stats.n_term_misses);
+		serd_reader_free(reader);
+	}
+	fclose(par_fd);
+
+	// Test that nodes have the same ID only if they have the same type
+	const char* const id_doc = "<0> <0> \"0\" .\n"
+	                           "<0> <0> \"1\"@en .\n"
+	                           "<1> <0> \"2\" .\n";
+
+	IdTest id_test = { { 0, 0 }, { 0, 0, 0, 0, 0, 0 }, 0 };
+	reader = serd_reader_new(
+		SERD_TURTLE, &id_test, NULL, NULL, NULL, NULL, NULL);
+	serd_reader_set_statement_id_sink(reader, id_sink, 0);
+	assert(!serd_reader_read_string(reader, USTR(id_doc)));
+	assert(id_test.pt.n_statements == 3 && id_test.max_id == 6);
+	assert(id_test.last.subject == 5 && id_test.last.predicate == 1);
+	assert(id_test.last.object == 6 && !id_test.last.object_lang);
+	serd_reader_free(reader);
+
+#ifdef HAVE_ZLIB
+	// Test reading a gzip file with two members, like bgzip writes
+	static const char gz_doc[] =
+		"\x1F\x8B\x08\x00\x00\x00\x00\x00\x02\x03\xB3\xC9\x28\x29\x29\xB0"
+		"\xD2\xD7\x4F\x4D\xD7\x2F\xB6\x53\xB0\x41\xF0\x0A\xEC\x14\x94\x0C"
+		"\x94\x14\xF4\xB8\x00\x38\x5D\xF4\x17\x22\x00\x00\x00\x1F\x8B\x08"
+		"\x00\x00\x00\x00\x00\x02\x03\x8B\x8E\x55\xB0\xC9\x28\x29\x29\xB0"
+		"\xD2\xD7\x4F\x4D\xD7\x2F\xB0\x53\x50\x32\x54\x52\xD0\xE3\x02\x00"
+		"\x97\x05\x02\x34\x17\x00\x00\x00";
+
+	FILE* const gz_fd = tmpfile();
+	fwrite(gz_doc, 1, sizeof(gz_doc) - 1, gz_fd);
+	fseek(gz_fd, 0, SEEK_SET);
+	pt.n_statements = pt.n_blanks = 0;
+	reader = serd_reader_new(
+		SERD_TURTLE, &pt, NULL, NULL, NULL, parallel_sink, NULL);
+	assert(!serd_reader_read_file_parallel(reader, gz_fd, USTR("test"), 2));
+	assert(pt.n_statements == 2 && pt.n_blanks == 1);
+
+	// Test streaming a gzip file a byte at a time, like serdi -e
+	serd_reader_free(reader);
+	fseek(gz_fd, 0, SEEK_SET);
+	pt.n_statements = pt.n_blanks = 0;
+	reader = serd_reader_new(
+		SERD_TURTLE, &pt, NULL, NULL, NULL, parallel_sink, NULL);
+	assert(!serd_reader_start_stream(reader, gz_fd, USTR("test"), false));
+	while (!serd_reader_read_chunk(reader)) {}
+	assert(!serd_reader_end_stream(reader));
+	assert(pt.n_statements == 2 && pt.n_blanks == 1);
+	fclose(gz_fd);
+
+	// Test that a truncated gzip file is an error
+	FILE* const trunc_fd = tmpfile();
+	fwrite(gz_doc, 1, 50, trunc_fd);
+	fseek(trunc_fd, 0, SEEK_SET);
+	pt.n_statements = pt.n_blanks = 0;
+	err.status      = SERD_SUCCESS;
+	serd_reader_set_error_sink(reader, quiet_error_sink, &err);
+	assert(serd_reader_read_file_handle(reader, trunc_fd, USTR("test")));
+	assert(pt.n_statements == 1);
+	fclose(trunc_fd);
+	serd_reader_free(reader);
+#endif
+
 	serd_env_free(env);
 
 	printf("Success\n");
@@ -0,0 +1,170 @@
+/*
+  Copyright 2019 David Robillard <http://drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/*
+  Microbenchmark of skipping whitespace and comments.
+
+  Input with a token byte between runs of whitespace and comments is skipped
+  from a byte source in memory, like a mapped file, in two ways: a byte at a
+  time like read_ws_star() without bulk skipping, and with the bulk skipping
+  it uses now.  Both must end with the same cursor.
+
+  Usage: serd_ws_bench [MEGABYTES] [RUNS]
+*/
+
+#undef NDEBUG
+
+#include "serd_internal.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+	const char* name;    ///< Description of input
+	const char* ws;      ///< Whitespace and comments between tokens
+} Layout;
+
+static const Layout layouts[] = {
+	{ "single spaces, like NTriples", " " },
+	{ "tab indentation", "\n\t\t" },
+	{ "64 bytes of indentation",
+	  "\n                                                               " },
+	{ "a comment per token", "  # A comment with some text in it\n  " },
+	{ "CRLF and blank lines", "\r\n\r\n    " }
+};
+
+/// Skip input a byte at a time, returning the number of token bytes
+static size_t
+skip_bytewise(SerdByteSource* source)
+{
+	size_t n_tokens = 0;
+	for (uint8_t c; (c = serd_byte_source_peek(source));) {
+		if (c == '#') {
+			while ((c = serd_byte_source_peek(source)) && c != 0xA && c != 0xD) {
+				serd_byte_source_advance(source);
+			}
+		} else {
+			n_tokens += !is_space((char)c);
+			serd_byte_source_advance(source);
+		}
+	}
+	return n_tokens;
+}
+
+/// Skip input with the bulk scanners where possible, as in read_ws_star()
+static size_t
+skip_bulk(SerdByteSource* source)
+{
+	size_t n_tokens = 0;
+	for (uint8_t c; (c = serd_byte_source_peek(source));) {
+		if (c == '#') {
+			serd_byte_source_advance(source);
+			size_t n = 0;
+			while ((n = serd_scan_comment(
+				        source->read_buf + source->read_head,
+				        serd_byte_source_available(source)))) {
+				serd_byte_source_skip(source, n);
+			}
+			while ((c = serd_byte_source_peek(source)) && c != 0xA && c != 0xD) {
+				serd_byte_source_advance(source);
+			}
+		} else if (is_space((char)c)) {
+			serd_byte_source_advance(source);
+			if (is_space((char)serd_byte_source_peek(source))) {
+				serd_byte_source_skip(
+					source,
+					serd_scan_ws(source->read_buf + source->read_head,
+					             serd_byte_source_available(source)));
+			}
+		} else {
+			++n_tokens;
+			serd_byte_source_advance(source);
+		}
+	}
+	return n_tokens;
+}
+
+/// Return the best time of `n_runs` runs of `skip` over `input` in seconds
+static double
+time_skip(size_t (*skip)(SerdByteSource*),
+          const uint8_t* input,
+          unsigned       n_runs,
+          size_t         n_tokens,
+          Cursor*        end)
+{
+	double best = 0.0;
+	for (unsigned r = 0; r < n_runs; ++r) {
+		SerdByteSource source;
+		serd_byte_source_open_string(&source, input);
+		serd_byte_source_prepare(&source);
+
+		const uint64_t t0 = serd_time_ns();
+		const size_t   n  = skip(&source);
+		const double   t  = (double)(serd_time_ns() - t0) / 1e9;
+
+		assert(n == n_tokens);
+		serd_byte_source_update_cursor(&source);
+		*end = source.cur;
+		best = (r == 0 || t < best) ? t : best;
+		serd_byte_source_close(&source);
+	}
+	return best;
+}
+
+int
+main(int argc, char** argv)
+{
+	const size_t   size   = (argc > 1 ? strtoul(argv[1], NULL, 10) : 32) << 20U;
+	const unsigned n_runs = argc > 2 ? (unsigned)strtoul(argv[2], NULL, 10) : 5;
+	if (!size || !n_runs) {
+		fprintf(stderr, "Usage: %s [MEGABYTES] [RUNS]\n", argv[0]);
+		return 1;
+	}
+
+	uint8_t* const input = (uint8_t*)malloc(size + 1);
+	printf("%-32s %12s %12s %8s\n", "Input", "Bytewise (s)", "Bulk (s)", "Speedup");
+	for (size_t i = 0; i < sizeof(layouts) / sizeof(Layout); ++i) {
+		// Fill the input with a token byte followed by the layout, repeated
+		const size_t ws_len   = strlen(layouts[i].ws);
+		size_t       n_tokens = 0;
+		size_t       len      = 0;
+		while (len + 1 + ws_len <= size) {
+			input[len++] = 'x';
+			memcpy(input + len, layouts[i].ws, ws_len);
+			len += ws_len;
+			++n_tokens;
+		}
+		input[len] = '\0';
+
+		Cursor       bytewise_end;
+		Cursor       bulk_end;
+		const double bytewise = time_skip(
+			skip_bytewise, input, n_runs, n_tokens, &bytewise_end);
+		const double bulk = time_skip(
+			skip_bulk, input, n_runs, n_tokens, &bulk_end);
+
+		assert(bytewise_end.line == bulk_end.line);
+		assert(bytewise_end.col == bulk_end.col);
+		assert(bytewise_end.offset == bulk_end.offset);
+		printf("%-32s %12.6f %12.6f %7.2fx\n",
+		       layouts[i].name, bytewise, bulk, bulk > 0 ? bytewise / bulk : 0.0);
+	}
+
+	free(input);
+	return 0;
+}